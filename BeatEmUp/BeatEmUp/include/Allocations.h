@@ -0,0 +1,61 @@
+#pragma once
+#include <SDL.h>
+
+
+//Heap allocation tracking
+//Global operator new/delete are replaced (Allocations.cpp) to count every
+//allocation the program makes. Totals are always kept (a couple of atomics);
+//profiler phases record how many happened inside them, per frame
+//Attribution to call sites is opt-in (EnableTags): ALLOC_TAG("name") charges
+//what the current thread allocates, until the end of the scope, to name
+//Zero-alloc check: while ExpectNone(true) is in force, every allocation is also
+//a violation (counted, with the tag it came from) for the caller to report
+class Allocations
+{
+public:
+	static const size_t MaxTags = 64;
+
+	struct TagStats
+	{
+		const char* tag;
+		Uint64 count;
+		Uint64 bytes;
+	};
+
+	static Uint64 Count(); //operator new calls since start
+	static Uint64 Bytes(); //bytes requested by them
+	static Uint64 Frees(); //operator delete calls (non-null) since start
+
+	//Per-tag counts (off by default - costs a table lookup per allocation)
+	static void EnableTags(bool enabled);
+	//Tag for the current thread's allocations (string literal); returns the previous one
+	static const char* SetTag(const char* tag);
+	//Copies out up to max tags, busiest first. Returns how many
+	static size_t Tags(TagStats* out, size_t max);
+	static void LogTags();
+
+	//Zero-alloc check. Returns the previous setting
+	static bool ExpectNone(bool enabled);
+	static Uint64 Violations();
+	static const char* LastViolation(); //tag of the latest one
+};
+
+
+//Charges the scope's allocations (on this thread) to tag
+struct AllocTag
+{
+	AllocTag(const char* tag) : previous(Allocations::SetTag(tag)) {}
+	~AllocTag() { Allocations::SetTag(previous); }
+	const char* const previous;
+};
+
+#define ALLOC_TAG(tag)	AllocTag allocTag_(tag)
+
+
+//Lifts the zero-alloc check for the scope (e.g. loading a level)
+struct AllowAllocations
+{
+	AllowAllocations() : previous(Allocations::ExpectNone(false)) {}
+	~AllowAllocations() { Allocations::ExpectNone(previous); }
+	const bool previous;
+};
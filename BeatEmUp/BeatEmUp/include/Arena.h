@@ -0,0 +1,66 @@
+#pragma once
+#include <SDL.h>
+#include <memory>
+#include <new>
+#include <vector>
+
+
+//Monotonic (bump) allocator for objects that live exactly as long as a level
+//Allocation is a pointer bump inside big blocks; nothing is freed one by one.
+//Objects placed here still need their destructor run (see World), but their
+//memory goes back in one go with Reset(), which keeps the blocks for reuse -
+//after the first level, loading another allocates nothing from the heap
+class Arena
+{
+public:
+	explicit Arena(size_t blockSize = 64 * 1024);
+
+	void* Allocate(size_t size, size_t alignment);
+
+	//Object of type T constructed in the arena. Caller runs ~T() (never delete)
+	template<class T, class... Args>
+	T* New(Args&&... args)
+	{
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	//Forgets everything allocated. Blocks are kept
+	void Reset();
+
+	//Stats
+	__forceinline size_t Used() const { return used; }
+	size_t Capacity() const;
+
+
+	//Arena that objects being built right now should come from (nullptr = heap)
+	//Lets helpers such as Sprite::FromFile follow the object that is creating them
+	static Arena* Current();
+
+private:
+	struct Block
+	{
+		std::unique_ptr<char[]> data;
+		size_t size;
+	};
+
+	const size_t blockSize;
+	std::vector<Block> blocks;
+	size_t block;	//block being filled
+	size_t offset;	//into it
+	size_t used;
+
+	friend struct ArenaScope;
+	static Arena* current;
+};
+
+
+
+//Makes arena Arena::Current() for the enclosing scope
+struct ArenaScope
+{
+	explicit ArenaScope(Arena* arena) : previous(Arena::current) { Arena::current = arena; }
+	~ArenaScope() { Arena::current = previous; }
+
+private:
+	Arena* const previous;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <SDL.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Util.h"
+#include "Atlas.h"
+
+
+#define ASSETS	AssetRegistry::Instance()
+
+
+class GlyphAtlas;
+
+
+//Shared handle to a loaded image
+//The image is the rect region of texture (the whole texture, or its place in an atlas page)
+//The texture is destroyed when the last handle goes away
+struct TextureRef
+{
+	std::shared_ptr<SDL_Texture> texture;
+	SDL_Rect rect;
+
+	TextureRef() { rect.x = rect.y = rect.w = rect.h = 0; }
+	explicit operator bool() const { return texture != nullptr; }
+};
+
+
+
+//Asset registry
+//Hands out shared textures keyed by file and colour key, so each image is
+//decoded and uploaded once no matter how many objects use it
+//Holds weak references only: textures live as long as someone uses them
+//(atlas pages are the exception - they are kept until ReleaseAtlas)
+class AssetRegistry : public util::Singleton<AssetRegistry>
+{
+public:
+	AssetRegistry();
+	~AssetRegistry();
+
+	//Packs the images into as few shared atlas pages as possible
+	//Texture() then hands out regions of the pages for them, so most sprites
+	//draw from the same texture. Images that don't fit get their own texture
+	void BuildAtlas(SDL_Renderer& renderer, const AtlasImage* images, size_t count);
+	void ReleaseAtlas();
+	__forceinline size_t AtlasPages() const { return pages.size(); }
+
+	TextureRef Texture(const std::string& file, SDL_Renderer& renderer, bool transparent = false
+		, Uint8 colKeyR = 0x00, Uint8 colKeyG = 0x00, Uint8 colKeyB = 0x00);
+
+	//Glyph atlas for the font at that size, rasterised on first use
+	std::shared_ptr<const GlyphAtlas> Font(const std::string& file, int size, SDL_Renderer& renderer);
+
+	//Stats
+	__forceinline size_t Loads() const { return loads; }
+	__forceinline size_t Hits() const { return hits; }
+	size_t Live() const;
+
+
+private:
+	struct Entry
+	{
+		std::weak_ptr<SDL_Texture> texture;
+		int w, h;
+	};
+
+	struct AtlasEntry
+	{
+		size_t page;
+		SDL_Rect rect;
+	};
+
+	static std::string Key(const std::string& file, bool transparent, Uint8 r, Uint8 g, Uint8 b);
+
+	std::map<std::string, Entry> textures;
+	std::map<std::string, AtlasEntry> atlas;
+	std::vector<std::shared_ptr<SDL_Texture>> pages;
+	std::map<std::string, std::weak_ptr<const GlyphAtlas>> fonts;
+	size_t loads;
+	size_t hits;
+};
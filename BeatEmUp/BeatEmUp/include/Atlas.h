@@ -0,0 +1,38 @@
+#pragma once
+#include <SDL.h>
+
+
+//Rectangle packer (shelf algorithm)
+//Rectangles are placed left to right along the current shelf; when one doesn't
+//fit a new shelf starts below the tallest item of the previous one
+//Feed items tallest first for tight packing
+class AtlasPacker
+{
+public:
+	AtlasPacker(int width, int height, int padding = 2);
+
+	//Finds room for a w x h rectangle. Returns false when the page is full
+	bool Insert(int w, int h, SDL_Rect& placed);
+	void Reset();
+
+	__forceinline int Width() const { return width; }
+	__forceinline int Height() const { return height; }
+	__forceinline int UsedHeight() const { return shelfY + shelfHeight; }
+
+private:
+	const int width;
+	const int height;
+	const int padding;
+	int shelfX;
+	int shelfY;
+	int shelfHeight;
+};
+
+
+
+//An image to be packed into the sprite atlas
+struct AtlasImage
+{
+	const char* file;
+	Uint8 colKeyR, colKeyG, colKeyB;
+};
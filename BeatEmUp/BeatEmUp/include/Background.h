@@ -10,16 +10,17 @@ class BackgroundLayer : public GameObject
 {	
 
 public:
-	BackgroundLayer(const std::string& filename, SDL_Renderer& renderer, int _screenWidth, int _screenHeight, float xVel);
+	//parallax: how far the layer moves per unit the camera moves (1 = with the world)
+	BackgroundLayer(const std::string& filename, SDL_Renderer& renderer, int _screenWidth, int _screenHeight, float parallax_);
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual bool ScreenSpace() const override { return true; }
 	virtual ~BackgroundLayer();
 
 
 private:
 	unique_ptr2<SDL_Texture> texture;
-	RectF pos1;
-	RectF pos2;
+	float parallax;
 	int screenWidth;
 	int screenHeight;
 };
@@ -33,7 +34,8 @@ public:
 	Background(int clientWidth, int clientHeight, SDL_Renderer& renderer
 		, const std::string& fileLayer1, const std::string& fileLayer2, const std::string& fileLayer3);
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual bool ScreenSpace() const override { return true; }
 	virtual ~Background();
 
 	//Getters/Setters
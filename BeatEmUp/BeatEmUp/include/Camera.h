@@ -0,0 +1,42 @@
+#pragma once
+#include <SDL.h>
+#include "Util.h"
+
+
+//Side-scrolling camera
+//Game objects live in world space and stay put when the view scrolls;
+//only the camera moves. Screen x = world x - camera x, applied once when
+//drawing (SpriteBatch translation), so scrolling costs the same for any
+//number of objects
+class Camera
+{
+public:
+	Camera(float viewWidth, float viewHeight)
+		: x(0.0f)
+		, prevX(0.0f)
+		, width(viewWidth)
+		, height(viewHeight)
+	{}
+
+	//Moves the view by dx (world units, + = right)
+	__forceinline void Scroll(float dx) { x += dx; }
+	__forceinline void Reset() { x = prevX = 0.0f; }
+
+	//Previous simulation state (render interpolation)
+	__forceinline void SavePosition() { prevX = x; }
+
+	//World x at the left edge of the screen
+	__forceinline float X() const { return x; }
+	//Same, between the last two simulation states (alpha 1 = current)
+	__forceinline float RenderX(float alpha) const { return prevX + (x - prevX) * alpha; }
+
+	//What the screen shows, in world space
+	__forceinline util::RectF View() const { return util::RectF(x, 0.0f, width, height); }
+
+
+private:
+	float x;
+	float prevX;
+	const float width;
+	const float height;
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+#include "Mixer.h"
+
+
+class GameObject;
+struct World;
+
+
+//Per-tick queue of combat events
+//Attacks land during the update pass (mostly from sprite frame callbacks), but
+//nothing is done about them there: they are queued and World::Update resolves
+//the lot in one batch once every object has moved. So every attack in a tick is
+//judged against the same state, and the outcome does not depend on which
+//object happened to update first
+//Events are kept in one array per type and resolved type by type, in the
+//order of Type below (each type in the order queued):
+//	Hit -> KnockDown -> Death -> Despawn -> sounds
+//Resolving can queue more (a hit knocks its target down, ...) - those go into
+//a later type's array and are resolved in the same batch
+//Main thread only (Update/Commit/OnIntegrated and the callbacks they fire)
+class Combat
+{
+public:
+	enum Type
+	{
+		T_Hit,			//target->OnHit(damage)
+		T_KnockDown,	//target->KnockedDown()
+		T_Death,		//target->OnDied()
+		T_Despawn,		//target leaves the world
+		T_Sound,		//attack swung/landed, death cry...
+		T_Count
+	};
+
+	struct Event
+	{
+		GameObject* source;
+		GameObject* target;
+		Uint8 damage;
+		Mixer::SoundEffect sound;
+	};
+
+	Combat(size_t initialCapacity = 16);
+
+	//attacker landed a blow on target
+	__forceinline void Hit(GameObject& attacker, GameObject& target, Uint8 damage = 1) { Push(T_Hit, &attacker, &target, damage); }
+	__forceinline void KnockDown(GameObject& source, GameObject& target) { Push(T_KnockDown, &source, &target); }
+	__forceinline void Death(GameObject& object) { Push(T_Death, &object, &object); }
+	__forceinline void Despawn(GameObject& object) { Push(T_Despawn, &object, &object); }
+	__forceinline void Sound(GameObject& source, Mixer::SoundEffect sound) { Push(T_Sound, &source, nullptr, 0, sound); }
+
+	//Carries out everything queued, then empties the queue
+	void Resolve(World& world);
+	void Clear();
+
+	__forceinline size_t Count(Type type) const { return events[type].size(); }
+	//Events resolved by the last Resolve
+	__forceinline size_t Resolved() const { return resolved; }
+
+
+private:
+	__forceinline void Push(Type type, GameObject* source, GameObject* target, Uint8 damage = 0, Mixer::SoundEffect sound = Mixer::SE_Punch)
+	{
+		events[type].push_back(Event{ source, target, damage, sound });
+	}
+
+	std::vector<Event> events[T_Count];
+	size_t resolved;
+};
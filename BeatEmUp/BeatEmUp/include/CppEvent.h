@@ -1,139 +1,175 @@
 #pragma once
+#include <string.h>
 #include <vector>
-#include <memory>
 
 
 namespace events
 {
-	// Base event handler class
-	template <typename TSender, typename TEventArgs>
-	struct EventHandlerBase
+	// Subscription handle returned by Event::attach, used to detach again
+	struct Token
 	{
-		// Notify method.  Must be implemented by child EventHandlers.
-		virtual void notify(TSender sender, TEventArgs e) const = 0;
-		virtual ~EventHandlerBase() = default;
+		unsigned int slot;
+		unsigned int generation; // 0 = not attached
 	};
 
+	static const Token NoToken = { 0, 0 };
 
-	// Member-function handler class, with two parameters support
-	template <typename TListener, typename TSender, typename TEventArgs>
-	struct EventHandler : public EventHandlerBase<TSender, TEventArgs>
-	{
-		typedef void (TListener::*MemberFuncPtr)(TSender, TEventArgs);
 
-		// .ctor..
-		EventHandler(TListener* object, MemberFuncPtr member) : object_(object), memberfunc_(member) {}
+	// Delegate - a callable stored by value, no heap and no virtual call.
+	// The target (member function pointer or free function) is copied into a
+	// small inline buffer; invoke is a thunk instantiated for the target's type
+	// that copies it back out and calls it
+	template <typename TSender, typename TEventArgs>
+	struct Delegate
+	{
+		// Large enough for any member function pointer. MSVC's biggest (virtual or
+		// unknown inheritance) is the code pointer plus three ints: 16 bytes on
+		// Win32, 24 on x64. Itanium ABI ones (gcc, clang) are two words
+		static const size_t BufferSize = (sizeof(void*) + 3 * sizeof(int) + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+		struct Incomplete; // gets the unknown inheritance representation
+		static_assert(sizeof(void (Incomplete::*)(TSender, TEventArgs)) <= BufferSize, "delegate buffer too small for member function pointers");
 
-		virtual ~EventHandler() { }
+		typedef void (*Thunk)(const Delegate&, TSender, TEventArgs);
 
-		// Notifies listeners
-		virtual void notify(TSender sender, TEventArgs e) const {
-			return (object_->*memberfunc_)(sender, e);
+		template <typename TListener>
+		static Delegate FromMember(TListener& object, void (TListener::*member)(TSender, TEventArgs))
+		{
+			typedef void (TListener::*MemberFuncPtr)(TSender, TEventArgs);
+			static_assert(sizeof(MemberFuncPtr) <= BufferSize, "member function pointer does not fit the delegate");
+
+			Delegate d;
+			d.object = &object;
+			d.invoke = &InvokeMember<TListener>;
+			memcpy(d.target, &member, sizeof(member));
+			return d;
 		}
 
-
-		// Determines if the given object and function are attached
-		// Returns true/false accordingly
-		bool handles(TListener* object, MemberFuncPtr member) const {
-			return object_ == object && memberfunc_ == member;
+		static Delegate FromFunction(void (*func)(TSender, TEventArgs))
+		{
+			Delegate d;
+			d.object = nullptr;
+			d.invoke = &InvokeFunction;
+			memcpy(d.target, &func, sizeof(func));
+			return d;
 		}
 
-	private:
-		TListener* object_;
-		MemberFuncPtr memberfunc_;
-	};
+		__forceinline void operator()(TSender sender, TEventArgs e) const { invoke(*this, sender, e); }
 
+		void* object;
+		Thunk invoke;
+		alignas(void*) unsigned char target[BufferSize];
 
-	// Non-member function handler class, with two parameters support
-	template <typename TSender, typename TEventArgs>
-	struct NonMemberEventHandler : public EventHandlerBase<TSender, TEventArgs>
-	{
-		typedef void(*FuncPtr)(TSender, TEventArgs);
-
-		// .ctor
-		NonMemberEventHandler(FuncPtr func) : func_(func) {}
-
-		virtual ~NonMemberEventHandler() { }
-
-		// Notifies listeners
-		virtual void notify(TSender sender, TEventArgs e) const {
-			return (*func_)(sender, e);
+	private:
+		template <typename TListener>
+		static void InvokeMember(const Delegate& d, TSender sender, TEventArgs e)
+		{
+			void (TListener::*member)(TSender, TEventArgs);
+			memcpy(&member, d.target, sizeof(member));
+			(static_cast<TListener*>(d.object)->*member)(sender, e);
 		}
 
-
-		// Determines if the given object and function are attached
-		// Returns true/false accordingly
-		bool handles(FuncPtr func) const {
-			return func_ == func;
+		static void InvokeFunction(const Delegate& d, TSender sender, TEventArgs e)
+		{
+			void (*func)(TSender, TEventArgs);
+			memcpy(&func, d.target, sizeof(func));
+			(*func)(sender, e);
 		}
-
-	private:
-		FuncPtr func_;
 	};
 
+
 	// Event class - Supports an event with two parameters and no return value
+	// Handlers are kept packed in one array so notify is a straight walk over it.
+	// Tokens name a slot, which knows where its handler currently sits; detach
+	// moves the last handler into the hole, so it is O(1) (and may reorder handlers).
+	// Only attach can allocate (when the arrays grow)
 	template <typename TSender, typename TEventArgs>
 	class Event
 	{
-	private:
-		std::vector<std::unique_ptr<EventHandlerBase<TSender, TEventArgs>>> handlers_;
-
 	public:
+		typedef events::Delegate<TSender, TEventArgs> Delegate;
+
 		// Attaches the given object and method to the event so that it can listen for notifications.
 		template <typename TListener>
-		void attach(TListener& object, void (TListener::*member)(TSender, TEventArgs)) {
-			handlers_.push_back(std::make_unique<EventHandler<TListener, TSender, TEventArgs>>(&object, member));
+		Token attach(TListener& object, void (TListener::*member)(TSender, TEventArgs)) {
+			return attach(Delegate::FromMember(object, member));
 		}
 
 		//Attaches a non-member event handler
-		void attach(void(*func)(TSender, TEventArgs)) {
-			handlers_.push_back(std::make_unique<NonMemberEventHandler<TSender, TEventArgs>>(func));
+		Token attach(void(*func)(TSender, TEventArgs)) {
+			return attach(Delegate::FromFunction(func));
 		}
 
-		//Detaches (or unsubscribes) the given object and method from this event.
-		template<typename TListener>
-		bool detach(TListener& object, void (TListener::*member)(TSender, TEventArgs))
+		Token attach(const Delegate& delegate)
 		{
-			for (unsigned int i = 0; i < handlers_.size(); ++i)
+			unsigned int slot;
+			if(freeSlot_ != NoSlot)
 			{
-				auto handler = dynamic_cast<EventHandler<TListener, TSender, TEventArgs>*>(handlers_[i].get());
-
-				if (handler && handler->handles(&object, member))
-				{
-					handlers_.erase(handlers_.begin() + i);
-					return true;
-				}
+				slot = freeSlot_;
+				freeSlot_ = slots_[slot].index;
+			}
+			else
+			{
+				slot = (unsigned int)slots_.size();
+				slots_.push_back(Slot{ 0, 0 });
 			}
 
-			return false;
+			Slot& s = slots_[slot];
+			if(++s.generation == 0) s.generation = 1; // 0 is NoToken
+			s.index = (unsigned int)handlers_.size();
+			handlers_.push_back(Handler{ delegate, slot });
+			return Token{ slot, s.generation };
 		}
 
-		// Detaches (or unsubscribes) the given non-member function from this event
-		bool detach(void(*func)(TSender, TEventArgs))
+		// Detaches (or unsubscribes) the handler attach returned token for.
+		// Stale tokens (already detached) are ignored
+		bool detach(Token& token)
 		{
-			for (unsigned int i = 0; i < handlers_.size(); ++i)
-			{
-				auto handler = dynamic_cast<NonMemberEventHandler<TSender, TEventArgs>*>(handlers_[i].get());
-
-				if (handler && handler->handles(func))
-				{
-					handlers_.erase(handlers_.begin() + i);
-					return true;
-				}
-			}
-
-			return false;
+			if(token.generation == 0 || token.slot >= slots_.size()) return false;
+			Slot& s = slots_[token.slot];
+			if(s.generation != token.generation) return false;
+
+			// Move the last handler into the hole
+			const unsigned int index = s.index;
+			handlers_[index] = handlers_.back();
+			slots_[handlers_[index].slot].index = index;
+			handlers_.pop_back();
+
+			// Bump the generation so the old token no longer matches, and recycle the slot
+			++s.generation;
+			s.index = freeSlot_;
+			freeSlot_ = token.slot;
+			token = NoToken;
+			return true;
 		}
 
+		__forceinline size_t count() const { return handlers_.size(); }
+
 		// Notifies attached objects of the occurrence of this event.
 		void notify(TSender sender, TEventArgs e) const
 		{
-			if (handlers_.size() <= 0) return;
-
 			for (unsigned int i = 0; i < handlers_.size(); ++i) {
-				handlers_[i]->notify(sender, e);
+				handlers_[i].delegate(sender, e);
 			}
 		}
+
+	private:
+		static const unsigned int NoSlot = ~0u;
+
+		struct Handler
+		{
+			Delegate delegate;
+			unsigned int slot; // owning slot, fixed up when the handler moves
+		};
+
+		struct Slot
+		{
+			unsigned int index; // into handlers_, or the next free slot
+			unsigned int generation;
+		};
+
+		std::vector<Handler> handlers_;
+		std::vector<Slot> slots_;
+		unsigned int freeSlot_ = NoSlot;
 	};
 
 }
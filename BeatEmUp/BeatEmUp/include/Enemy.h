@@ -1,8 +1,10 @@
 #pragma once
 #include "GameObject.h"
 #include "Sprite.h"
-#include <queue>
+#include <vector>
 #include "Util.h"
+#include "Handle.h"
+#include "Mixer.h"
 
 
 
@@ -16,13 +18,14 @@ public:
 	Rock(const string& file, SDL_Renderer& renderer);
 	virtual ~Rock();
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
 
 public:
 	static const float Range;
 
 private:
-	unique_ptr2<SDL_Texture> texture;
+	shared_ptr<SDL_Texture> texture;
+	SDL_Rect region;
 };
 
 
@@ -41,6 +44,23 @@ enum class EnemyState
 };
 
 
+//Path nodes waiting to be visited, first in first out. Storage is reserved
+//up front and reused once the path is walked, so Think never allocates
+class VisitPath
+{
+public:
+	VisitPath() : next(0) { nodes.reserve(4); }
+	__forceinline bool empty() const { return next == nodes.size(); }
+	__forceinline const SDL_Point& front() const { return nodes[next]; }
+	__forceinline void push(const SDL_Point& p) { nodes.push_back(p); }
+	__forceinline void pop() { if(++next == nodes.size()) { nodes.clear(); next = 0; } }
+
+private:
+	vector<SDL_Point> nodes;
+	size_t next;
+};
+
+
 class Enemy : public GameObject
 {
 public:
@@ -62,25 +82,46 @@ public:
 );
 
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual RectF DrawBounds() const override { return current->Position(); }
+	virtual void OnIntegrated() override;
+	virtual bool Grounded() const override { return jumpState == JumpState::Ground; }
 	virtual ~Enemy();
 
-	void OnHit();
+	//AI runs on the workers: Think() only reads the rest of the game (other
+	//enemies through their committed state) and queues up sounds and its death;
+	//Commit() hands them to World::combat on the main thread. Its move is picked up by the
+	//kinematics pass (Kinematics::Gather) while it is awake
+	virtual bool ParallelUpdate() const override { return true; }
+	virtual void Think() override;
+	virtual void Commit() override;
+
+	virtual void OnHit(Uint8 damage = 1) override;
+	virtual void KnockedDown() override;
+	virtual void OnDied() override;
 
 	__forceinline bool IsDead() const { return state == EnemyState::Dead; }
+	__forceinline Handle GetHandle() const { return handle; }
+
+	//AI level of detail: only enemies woken this tick (near the view, see
+	//Game::WakeEnemies) think, move and animate; the rest stand still, asleep
+	//Only enemies on the ground and idling or patrolling can fall asleep, so
+	//a knock-down, jump or chase is always played out
+	__forceinline void Wake(Uint64 tick) { wakeTick = tick; }
+	__forceinline bool IsAsleep() const { return asleep; }
+	__forceinline void SetHandle(const Handle& h) { handle = h; }
 	__forceinline bool IsAttackable() const {
 		return state !=	EnemyState::KnockedDown && state != EnemyState::Dead;
 	}
 	
 
 	//Chasing - alternate path info
-	queue<SDL_Point> visitPath;
+	VisitPath visitPath;
 
 protected:
 	virtual void Propagate();
 
 private:
-	void Translate();
 	void Translate(bool anim);
 	void Walk(Direction dir);
 	void Visit();
@@ -95,6 +136,7 @@ private:
 	void OnAttack();
 	void OnIdle();
 	void OnVisit(EnemyState destState);
+	void PlaySound(Mixer::SoundEffect effect);
 
 protected:
 	Sprite::ptr idleRight;
@@ -107,6 +149,8 @@ protected:
 	Sprite::ptr fallRight;
 	Sprite::ptr attackRight;
 	Sprite::ptr attackLeft;
+	events::Token attackRightToken; //FramePlayed subscriptions, set by the subclass
+	events::Token attackLeftToken;
 	Sprite* current;
 
 	EnemyState state;
@@ -129,6 +173,22 @@ protected:
 	VectF jumpLocation;
 	static const float Gravity;
 	static const int JumpHeight;
+	static const Uint32 CorpseTime; //ms a dead enemy stays on screen
+
+private:
+	Handle handle; //in GAME.enemies
+	Uint64 wakeTick; //last tick woken
+	bool asleep;
+
+	util::Random rng; //own stream (forked from __WHEEL), so thinking in parallel needs no shared generator
+	EnemyState committedState; //state as of the last Commit - what other enemies see
+
+	//Queued by Think(), done by Commit()
+	static const Uint8 MaxSounds = 2;
+	Mixer::SoundEffect sounds[MaxSounds];
+	Uint8 soundCount;
+	bool died; //queue its death with World::combat
+	bool expired; //corpse time is up, queue its despawn
 };
 
 
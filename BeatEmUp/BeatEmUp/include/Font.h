@@ -0,0 +1,48 @@
+#pragma once
+#include <SDL.h>
+#include <memory>
+#include <string>
+#include "Util.h"
+#include "SpriteBatch.h"
+
+
+//Glyph atlas for one font at one size
+//The printable ASCII glyphs are rasterised once (white, antialiased) into a single
+//texture; text is then laid out as one quad per glyph and tinted through the batch,
+//so drawing text never renders or uploads anything
+class GlyphAtlas
+{
+public:
+	static const int FirstGlyph = ' ';
+	static const int LastGlyph = '~';
+	static const int GlyphCount = LastGlyph - FirstGlyph + 1;
+
+	GlyphAtlas(const std::string& fileName, int size, SDL_Renderer& renderer);
+
+	__forceinline explicit operator bool() const { return texture != nullptr; }
+	__forceinline int LineHeight() const { return lineHeight; }
+
+	//Size of text on one line, from the cached advances
+	int Measure(const std::string& text) const;
+
+	//Queues text with its top-left corner at x, y
+	void Draw(SpriteBatch& batch, const std::string& text, float x, float y, const SDL_Colour& colour) const;
+
+
+private:
+	struct Glyph
+	{
+		SDL_Rect rect;	//in the atlas texture, full line height
+		int advance;
+	};
+
+	__forceinline const Glyph& Find(char c) const
+	{
+		//Anything outside the atlas shows as '?'
+		return (c >= FirstGlyph && c <= LastGlyph)? glyphs[c - FirstGlyph]: glyphs['?' - FirstGlyph];
+	}
+
+	std::shared_ptr<SDL_Texture> texture;
+	Glyph glyphs[GlyphCount];
+	int lineHeight;
+};
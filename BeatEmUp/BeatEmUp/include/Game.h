@@ -5,7 +5,11 @@
 #include "Player.h"
 #include "Roamer.h"
 #include "Enemy.h"
+#include "SpatialGrid.h"
 #include "Text.h"
+#include "GameClock.h"
+#include "Camera.h"
+#include "InputRecording.h"
 
 
 const int SCREEN_WIDTH = 800;
@@ -24,6 +28,8 @@ public:
 	//Accessors
 	__forceinline int MidSectionY(int myHeight) const { return clientHeight_ - myHeight - (int)(MoveBounds.h / 2); }
 	__forceinline int MidSectionX(int myWidth) const { return (clientWidth_ / 2) - (myWidth / 2); }
+	//MoveBounds is relative to the screen - this is where it is in the world now
+	__forceinline RectF WorldMoveBounds() const { return RectF(MoveBounds.x + camera.X(), MoveBounds.y, MoveBounds.w, MoveBounds.h, MoveBounds.z); }
 	
 	__forceinline int RandomYWithinMoveBounds(int myHeight) const
 	{
@@ -39,23 +45,85 @@ public:
 	virtual void ProcessEvent(const SDL_Event& e) override;
 	virtual void Update() override;
 	virtual void Render() override;
+	virtual float TimeScale() const override { return clock.TimeScale(); }
+
+
+	//Stress-test scene - when set, LoadNextLevel spawns this many of each
+	//instead of the hand-placed level (spread over a world wide enough for them)
+	struct StressConfig
+	{
+		size_t andores, axls, jokers, roamers, rocks;
+
+		__forceinline size_t Enemies() const { return andores + axls + jokers; }
+		__forceinline bool Any() const { return Enemies() || roamers || rocks; }
+		//count enemies split between the three kinds, a roamer per 10 and a rock per 100
+		static StressConfig Scaled(size_t count);
+	};
+	__forceinline void SetStress(const StressConfig& config) { stress = config; }
+
+	//Throughput benchmark (headless): for each enemy count, runs a stress level
+	//for ticks ticks with scripted input and prints update and draw preparation
+	//times, heap allocations per tick and ticks per second
+	//Drawing goes through the sprite batch in dry-run mode (nothing is rendered)
+	int RunBenchmark(const vector<size_t>& counts, unsigned int ticks);
+	//Self-check (--selftest, headless): runs the same stress level twice from the
+	//seed with scripted input, each time with a fresh level and player, and
+	//reports whether both runs end in the same state
+	bool CheckDeterminism(size_t count, unsigned int ticks);
+
+	//Zero-alloc steady state test: from tick warmupTicks on, every tick and frame
+	//must run without touching the heap (level loads excepted). Ones that do are
+	//logged (with the allocation tag) and counted
+	__forceinline void SetZeroAllocCheck(Uint64 warmupTicks) { zeroAllocAfter = SDL_max(warmupTicks, (Uint64)1); }
+	__forceinline Uint64 ZeroAllocFailures() const { return zeroAllocFailures; }
+
+	//Input recording (see InputRecording): the player's actions from Init on are
+	//recorded, SaveRecording writes them out with the seed and the final state
+	__forceinline void SetRecordInput(bool enabled) { recordInput = enabled; }
+	bool SaveRecording(const string& fileName);
+	//Replay: plays a recording back instead of the keyboard, then quits on the
+	//tick it ended on. Must be set before Init (it seeds the random numbers)
+	bool SetReplay(const string& fileName);
+	//Reports whether the replay ended in the recorded state
+	bool CheckReplay() const;
+	__forceinline bool IsReplaying() const { return recording.IsPlaying(); }
 
 
 private:
 	void Stop();
 	bool LoadNextLevel();
 	bool LevelComplete() const;
+	void AddEnemy(Enemy* enemy);
+	void WakeEnemies();
+	void UpdateProfilerOverlay();
+	void SpawnStress();
+	void ScriptInput(Uint64 tick);
+	static bool KeyAction(SDL_Keycode key, bool pressed, InputRecording::Action& action);
+	void Act(InputRecording::Action action);
+	Uint32 StateChecksum() const;
+	__forceinline bool ZeroAllocChecking() const { return zeroAllocAfter && clock.Ticks() >= zeroAllocAfter; }
 
 public:
 	//area of the screen where objects can move/roam
 	const RectF MoveBounds;
 
+	//Simulation time - gameplay timers must use this rather than SDL_GetTicks()
+	GameClock clock;
+
+	//View onto the world (scrolling)
+	Camera camera;
+
 	//Game objects - Owned
 	unique_ptr<Player> player;
 	unique_ptr<TextBlock> tbFps, tbPlayerPos, tbEnemyPos;
-	unique_ptr<World> world;
+	vector<unique_ptr<TextBlock>> tbProfile; //one line per profiler phase (F2)
+	unique_ptr<World> world; //objects in levelArenas[levelArena]
+	unique_ptr<SpriteBatch> batch;
 	//non-owned
-	vector<Enemy*> enemies;
+	HandleTable<Enemy> enemies; //alive ones
+	SpatialGrid<Enemy> enemyGrid; //live enemies, for proximity queries
+	float wakeRadius; //enemies further than this (px) beyond the edges of the view sleep
+	size_t awakeEnemies; //woken this tick
 	Background* bg;
 
 private:
@@ -63,8 +131,31 @@ private:
 	bool rightDown;
 	bool upDown;
 	bool downDown;
+	bool showProfiler;
 
 	size_t currentLevel;
 	const size_t MaxLevel;
+	StressConfig stress;
+	Uint64 zeroAllocAfter; //first tick checked, 0 = off
+	Uint64 zeroAllocFailures;
+	bool recordInput;
+	InputRecording recording;
+
+	//What the HUD last showed: its text is rebuilt (into hudLine, no
+	//allocation) only when one of these changes
+	struct HudValues
+	{
+		float fps;
+		size_t drawCalls, quads, drawn, culled, awake, enemies;
+		Uint64 tasks, steals;
+		int x, y, z, health;
+	};
+	HudValues hud;
+	char hudLine[192];
+
+	//Level memory: the new level is built while the previous one is still
+	//alive (see LoadNextLevel), so two arenas take turns
+	Arena levelArenas[2];
+	size_t levelArena;
 };
 
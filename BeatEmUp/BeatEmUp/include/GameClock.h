@@ -0,0 +1,43 @@
+#pragma once
+#include <SDL.h>
+
+
+//Game (simulation) clock
+//Advances by one fixed step per simulation tick, so gameplay timers don't depend
+//on wall-clock time: the game can be paused, slowed down, sped up or run flat
+//out (headless) and the timers still agree with the physics
+//The only time source gameplay code should read
+class GameClock
+{
+public:
+	GameClock(unsigned int ticksPerSecond)
+		: hz(ticksPerSecond)
+		, ticks(0)
+		, timeScale(1.0f)
+		, paused(false)
+	{}
+
+	//Called once per simulation tick
+	__forceinline void Tick() { if (!paused) ++ticks; }
+	__forceinline void Reset() { ticks = 0; }
+
+	//Game time (ms) since start
+	__forceinline Uint32 Now() const { return (Uint32)(ticks * 1000 / hz); }
+	__forceinline Uint64 Ticks() const { return ticks; }
+	__forceinline unsigned int Hz() const { return hz; }
+
+	//Simulation speed relative to real time (windowed mode only)
+	__forceinline float TimeScale() const { return timeScale; }
+	__forceinline void SetTimeScale(float scale) { timeScale = SDL_max(0.125f, SDL_min(scale, 8.0f)); }
+
+	__forceinline bool IsPaused() const { return paused; }
+	__forceinline void Pause() { paused = true; }
+	__forceinline void Resume() { paused = false; }
+	__forceinline void TogglePause() { paused = !paused; }
+
+private:
+	const unsigned int hz;
+	Uint64 ticks;
+	float timeScale;
+	bool paused;
+};
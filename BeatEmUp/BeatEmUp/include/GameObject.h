@@ -3,8 +3,15 @@
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include "Util.h"
+#include "Profiler.h"
+#include "SpriteBatch.h"
+#include "Kinematics.h"
+#include "Combat.h"
+#include "Arena.h"
+#include "Workers.h"
 
 
 using namespace std;
@@ -56,18 +63,20 @@ protected:
 		, angle(0.0000)
 		, speedX(speed_)
 		, speedY(speed_ / 2.0f)
+		, kinematicId(-1)
 	{}
 
 public:
 	virtual ~GameObject() = default;
 	virtual void Update() = 0;
-	virtual void Draw(SDL_Renderer& renderer) const = 0;
+	virtual void Draw(SpriteBatch& batch) const = 0;
 	virtual void SetAngle(double theta) { angle = theta; }
 	__forceinline virtual void SetDirection(Direction dir) { direction = dir; }
 
 	
 	//Accessors
 	__forceinline RectF& Position() { return position; }
+	__forceinline const RectF& Position() const { return position; }
 	__forceinline Direction GetDirection() const { return direction; }
 	__forceinline double GetAngle() const { return angle; }
 	__forceinline float XVel() const { return xVel; }
@@ -76,7 +85,7 @@ public:
 	__forceinline float GetSpeedY() const { return speedY; }
 	__forceinline int GetHealth() const { return health; }
 	__forceinline Type GetType() const { return type; }
-	__forceinline string GetName() const { return name; }
+	__forceinline const string& GetName() const { return name; }
 
 
 	//Mutators
@@ -89,32 +98,49 @@ public:
 	bool CollidedWith(const RectF& other, const int penThresholdX = 25, const int penThresholdY = 25, const int penThresholdZ = 25) const;
 	void AdjustZToGameDepth();
 
-	
-	template<class GameObjectType>
-	GameObjectType* GetNearestNeighbour(const vector<GameObjectType*>& neighbours) const
-	{
-		for(const auto neighbour : neighbours)
-		{
-			if( neighbour != this &&
-				(position.right() >= neighbour->position.left()) &&
-				(position.left() <= neighbour->position.right())
-			)
-			{
-				logPrintf("%s: %s in range", this->GetName().c_str(), neighbour->GetName().c_str());
-				return neighbour;
-			}
-		}
 
-		return nullptr;
-	}
+	//Render interpolation
+	//Remembers the current position as the previous simulation state
+	__forceinline void SavePosition() { prevPosition = position; }
+	//Moves rect (own or a child sprite's position) back towards the previous
+	//simulation state, by how far the renderer is between the last two states
+	RectF Interpolate(const RectF& rect) const;
+
+	//Called once the Kinematics store has moved the object this tick
+	//(only for objects registered with World::kinematics)
+	virtual void OnIntegrated() {}
+	//Whether the kinematics pass keeps it on the floor (see Kinematics::Gather)
+	virtual bool Grounded() const { return true; }
+
+	//Combat outcomes, carried out by World::combat once the update pass is over
+	virtual void OnHit(Uint8 damage) {}
+	virtual void KnockedDown() {}
+	virtual void OnDied() {}
+
+	//What Draw() paints, in screen space (before interpolation)
+	//Objects drawing through a child sprite report the sprite's rect
+	virtual RectF DrawBounds() const { return position; }
+
+	//Screen-space objects (HUD, background) are drawn where they are; everything
+	//else is in world space and moves on screen with the camera
+	virtual bool ScreenSpace() const { return false; }
+
+	//Objects whose update splits into Think() - deciding, on a worker thread,
+	//touching nothing but itself - and Commit() - applying whatever affects
+	//others, on the main thread. World::Update calls those instead of Update()
+	virtual bool ParallelUpdate() const { return false; }
+	virtual void Think() {}
+	virtual void Commit() {}
 
 
 	//Functor for sorting Game objects by depth (z axis)
 	//Used for painting
 	friend struct GameObjectSortByDepth;
+	friend class Kinematics;
 
 protected:
 	RectF position;
+	RectF prevPosition;
 	float xVel, yVel;
 	float speedX, speedY;
 
@@ -124,6 +150,7 @@ private:
 	double angle; //rotation angle
 	int health;
 	Type type;
+	int kinematicId; //index into World::kinematics, -1 if not registered
 };
 
 
@@ -132,15 +159,19 @@ namespace GameObjectDeleters
 {
 	static auto Delete = [](GameObject* obj) { delete obj; };
 	static auto NoDelete = [](GameObject*) { };
+	static auto Destroy = [](GameObject* obj) { obj->~GameObject(); }; //arena memory
 }
 
 
 
 //Functor for sorting Game objects by depth (z axis) 
 struct GameObjectSortByDepth {
-	__forceinline bool operator()(const GameObject::ptr& a, const GameObject::ptr& b) const {
+	__forceinline bool operator()(const GameObject* a, const GameObject* b) const {
 		return a->position.z < b->position.z;
 	}
+	__forceinline bool operator()(const GameObject::ptr& a, const GameObject::ptr& b) const {
+		return (*this)(a.get(), b.get());
+	}
 };
 
 
@@ -148,11 +179,18 @@ struct GameObjectSortByDepth {
 //Container for all the drawable game objects
 //Owned objects memory is managed automatically
 //Non-owned objects can also be added
+//Painting order is kept in a separate list, so sorting never touches ownership
+//Given an arena, owned objects (and whatever they create while being
+//constructed, e.g. their sprites) are placed in it: destroying the world
+//then only runs destructors, the memory goes back with Arena::Reset()
 struct World
 {
-	World(const size_t initialCapacity = 50)
+	World(Arena* arena = nullptr, const size_t initialCapacity = 50)
+		: arena_(arena)
 	{
 		gameObjects_.reserve(initialCapacity);
+		drawOrder_.reserve(initialCapacity);
+		visible_.reserve(initialCapacity);
 	}
 
 
@@ -163,6 +201,7 @@ struct World
 	void AddGameObject(const GameObject& object)
 	{
 		gameObjects_.emplace_back(const_cast<GameObject*>(&object), GameObjectDeleters::NoDelete);
+		Track(gameObjects_.back().get());
 	}
 
 
@@ -175,9 +214,9 @@ struct World
 	{
 		try
 		{
-			GameObject::ptr object(new T, GameObjectDeleters::Delete);
+			GameObject::ptr object(Create<T>(), arena_? GameObjectDeleters::Destroy: GameObjectDeleters::Delete);
 			GameObject* p = object.get();
-			if (p) gameObjects_.push_back(std::move(object));
+			if (p) Track(p), gameObjects_.push_back(std::move(object));
 			return p;
 		}
 		catch (...)
@@ -195,9 +234,9 @@ struct World
 	{
 		try
 		{
-			GameObject::ptr object(new T(std::forward<Args>(args)...), GameObjectDeleters::Delete);
+			GameObject::ptr object(Create<T>(std::forward<Args>(args)...), arena_? GameObjectDeleters::Destroy: GameObjectDeleters::Delete);
 			T* p = dynamic_cast<T*>(object.get());
-			if (p) gameObjects_.push_back(std::move(object));
+			if (p) Track(p), gameObjects_.push_back(std::move(object));
 			return p;
 		}
 		catch (...)
@@ -207,23 +246,172 @@ struct World
 	}
 
 
-	void Draw(SDL_Renderer& renderer)
+	//Sort by depth, skip whatever is outside view, then draw
+	//The order is kept for everything (not just what is visible) so the
+	//incremental sort stays near-linear as objects come in and out of view
+	//screen: the client area; cameraX: world x at its left edge
+	void Draw(SpriteBatch& batch, const RectF& screen, float cameraX)
 	{
-		//Sort by depth, then draw
-		std::sort(gameObjects_.begin(), gameObjects_.end(), GameObjectSortByDepth());
-		std::for_each(gameObjects_.begin(), gameObjects_.end(), [&](const auto& obj) { obj->Draw(renderer); });
+		ALLOC_TAG("World::Draw");
+		{
+			PROFILE_SCOPE(Profiler::PH_Sort);
+			SortDrawOrder();
+		}
+		{
+			PROFILE_SCOPE(Profiler::PH_Cull);
+			Cull(screen, cameraX);
+		}
+		{
+			PROFILE_SCOPE(Profiler::PH_Draw);
+			std::for_each(visible_.begin(), visible_.end(), [&](const GameObject* obj)
+			{
+				batch.SetTranslation(obj->ScreenSpace()? 0.0f: -cameraX, 0.0f);
+				obj->Draw(batch);
+			});
+			batch.SetTranslation(0.0f, 0.0f);
+			batch.Flush();
+		}
 	}
 
 
-	void Update()
+	//Visibility stats of the last Draw
+	__forceinline size_t Drawn() const { return visible_.size(); }
+	__forceinline size_t Culled() const { return drawOrder_.size() - visible_.size(); }
+
+
+	//Behaviour first, then movement for everything in kinematics in one pass,
+	//then whatever combat that turned up is resolved in one batch
+	//Parallel objects think all at once on the workers, then everything is
+	//updated/committed serially in the order it was added, so the outcome
+	//does not depend on how the thinking was scheduled
+	//groundTop: top of the play area
+	void Update(float groundTop, Workers& workers)
 	{
+		ALLOC_TAG("World::Update");
+		{
+			PROFILE_SCOPE(Profiler::PH_Think);
+			workers.ParallelFor(thinkers_.size(), ThinkGrain, [this](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					thinkers_[i]->Think();
+			});
+		}
+
 		for (auto& object : gameObjects_)
-			object->Update();
+		{
+			if (object->ParallelUpdate()) object->Commit();
+			else object->Update();
+		}
+
+		kinematics.Gather();
+		kinematics.Integrate(groundTop);
+		kinematics.WriteBack();
+		combat.Resolve(*this);
+		FlushKills();
+	}
+
+
+	//Takes the object out of the world at the end of this update (safe to call
+	//from inside Update/callbacks). Owned objects are destroyed then
+	void Kill(GameObject& object)
+	{
+		kills_.push_back(&object);
+	}
+
+
+	//Snapshot of every object's position before a simulation step
+	//(the previous state for render interpolation)
+	void SavePositions()
+	{
+		for (auto& object : gameObjects_)
+			object->SavePosition();
 	}
 
 
 private:
+	static const size_t ThinkGrain = 8; //objects per worker chunk
+
+	void Track(GameObject* object)
+	{
+		object->SavePosition();
+		drawOrder_.push_back(object);
+		if (object->ParallelUpdate()) thinkers_.push_back(object);
+	}
+
+	template <class T, class... Args>
+	T* Create(Args&&... args)
+	{
+		ArenaScope scope(arena_);
+		if (arena_) return arena_->New<T>(std::forward<Args>(args)...);
+		return new T(std::forward<Args>(args)...);
+	}
+
+	void FlushKills()
+	{
+		if (kills_.empty()) return;
+
+		const std::less<const GameObject*> before;
+		std::sort(kills_.begin(), kills_.end(), before);
+		kills_.erase(std::unique(kills_.begin(), kills_.end()), kills_.end());
+		auto killed = [&](const GameObject* obj) { return std::binary_search(kills_.begin(), kills_.end(), obj, before); };
+
+		for (const auto obj : kills_)
+			kinematics.Remove(*obj);
+		drawOrder_.erase(std::remove_if(drawOrder_.begin(), drawOrder_.end(), killed), drawOrder_.end());
+		visible_.erase(std::remove_if(visible_.begin(), visible_.end(), killed), visible_.end());
+		thinkers_.erase(std::remove_if(thinkers_.begin(), thinkers_.end(), killed), thinkers_.end());
+		gameObjects_.erase(std::remove_if(gameObjects_.begin(), gameObjects_.end()
+			, [&](const GameObject::ptr& obj) { return killed(obj.get()); }), gameObjects_.end());
+		kills_.clear();
+	}
+
+	void Cull(const RectF& screen, float cameraX)
+	{
+		//Slack for render interpolation and rotation (the rock spins in place)
+		const float Margin = 32.0f;
+		const float left = screen.left() - Margin, right = screen.right() + Margin;
+		const float top = screen.top() - Margin, bottom = screen.bottom() + Margin;
+
+		visible_.clear();
+		for (const auto obj : drawOrder_)
+		{
+			RectF bounds = obj->DrawBounds();
+			if (!obj->ScreenSpace()) bounds.x -= cameraX;
+			if (bounds.right() < left || bounds.left() > right || bounds.bottom() < top || bounds.top() > bottom)
+				continue;
+			visible_.push_back(obj);
+		}
+	}
+
+	//Insertion sort: the order is already right from the last frame except for
+	//the few objects that changed depth, so this is close to one linear pass
+	//It is stable, but over the last frame's order: objects at the same depth
+	//keep whatever order they had last frame, which depends on how they moved
+	void SortDrawOrder()
+	{
+		const GameObjectSortByDepth less;
+		for (size_t i = 1; i < drawOrder_.size(); ++i)
+		{
+			GameObject* const object = drawOrder_[i];
+			size_t j = i;
+			for (; j > 0 && less(object, drawOrder_[j - 1]); --j)
+				drawOrder_[j] = drawOrder_[j - 1];
+			drawOrder_[j] = object;
+		}
+	}
+
+	Arena* const arena_;
 	vector<GameObject::ptr> gameObjects_;
+	vector<GameObject*> drawOrder_; //same objects, back to front
+	vector<GameObject*> kills_; //to go at the end of the update
+	vector<GameObject*> visible_; //drawOrder_ minus culled, rebuilt every Draw
+	vector<GameObject*> thinkers_; //objects with ParallelUpdate(), in the order added
+
+public:
+	//Transforms of the moving objects, as arrays
+	Kinematics kinematics;
+	//Hits, knock-downs, deaths... of this tick, resolved at the end of Update
+	Combat combat;
 };
 
 
@@ -255,7 +443,7 @@ public:
 
 	virtual ~Ball()
 	{
-		logPrintf("Ball object destroyed");
+		logTrace("Ball object destroyed");
 	}
 
 	void Update() override
@@ -272,7 +460,7 @@ public:
 		SDL_Delay(1);
 	}
 
-	void Draw(SDL_Renderer& renderer) const override
+	void Draw(SpriteBatch& batch) const override
 	{
 		SDL_SetRenderDrawColor( renderer, c.r, c.g, c.b, c.a );
 		SDL_RenderFillRect( renderer, &r );
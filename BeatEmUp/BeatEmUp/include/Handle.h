@@ -0,0 +1,98 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+
+
+//Generational handle: a slot index plus the generation of the object that
+//had the slot when the handle was made. Once the object is removed the slot's
+//generation moves on, so old handles safely resolve to nothing
+struct Handle
+{
+	Uint32 index;
+	Uint32 generation; //0 = never valid
+
+	Handle() : index(0), generation(0) {}
+	Handle(Uint32 index_, Uint32 generation_) : index(index_), generation(generation_) {}
+
+	__forceinline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+	__forceinline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+
+
+//Table of non-owned objects addressed by Handle
+//Add/Remove/Get are O(1); freed slots are reused
+template<class T>
+class HandleTable
+{
+public:
+	HandleTable() : count(0) {}
+
+	Handle Add(T* object)
+	{
+		Uint32 index;
+		if(!freeSlots.empty())
+		{
+			index = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			index = (Uint32)slots.size();
+			slots.push_back(Slot{ nullptr, 1 });
+		}
+
+		slots[index].object = object;
+		++count;
+		return Handle(index, slots[index].generation);
+	}
+
+	//No-op for stale handles
+	void Remove(const Handle& handle)
+	{
+		if(!Get(handle)) return;
+
+		Slot& slot = slots[handle.index];
+		slot.object = nullptr;
+		++slot.generation;
+		freeSlots.push_back(handle.index);
+		--count;
+	}
+
+	//nullptr once the object has been removed
+	__forceinline T* Get(const Handle& handle) const
+	{
+		if(handle.index >= slots.size()) return nullptr;
+		const Slot& slot = slots[handle.index];
+		return slot.generation == handle.generation? slot.object: nullptr;
+	}
+
+	//Removes everything (outstanding handles all go stale)
+	void Clear()
+	{
+		for(Uint32 i = 0; i < (Uint32)slots.size(); ++i)
+			Remove(Handle(i, slots[i].generation));
+	}
+
+	__forceinline size_t Count() const { return count; }
+
+	//fn(T*) for every object, in slot order
+	template<class Fn>
+	void ForEach(Fn fn) const
+	{
+		for(const Slot& slot : slots)
+			if(slot.object) fn(slot.object);
+	}
+
+
+private:
+	struct Slot
+	{
+		T* object;
+		Uint32 generation;
+	};
+
+	std::vector<Slot> slots;
+	std::vector<Uint32> freeSlots;
+	size_t count;
+};
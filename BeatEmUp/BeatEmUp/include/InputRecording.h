@@ -0,0 +1,94 @@
+#pragma once
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+
+//Recorded game session: the random seed plus every player action, stamped with
+//the simulation tick it took effect on. The simulation only depends on those
+//(see GameClock), so feeding the actions back in on the same ticks replays the
+//session exactly - at any speed, windowed or headless
+//The state checksum taken at the end of the recording lets a replay tell
+//whether it came out the same (e.g. after optimising gameplay code)
+//File format (little endian):
+//	"BEUR" version:u8 seed:u64 endTick:u64 checksum:u32 count:u32
+//	count x { tick delta from the previous action: varint, action: u8 }
+class InputRecording
+{
+public:
+	enum Action : Uint8
+	{
+		A_LeftPress, A_LeftRelease,
+		A_RightPress, A_RightRelease,
+		A_UpPress, A_UpRelease,
+		A_DownPress, A_DownRelease,
+		A_Jump, A_Punch, A_Kick,
+		A_Count
+	};
+
+	enum Mode
+	{
+		M_Off, M_Recording, M_Playing
+	};
+
+	InputRecording();
+
+	//Recording
+	void Start(Uint64 seed);
+	void Record(Uint64 tick, Action action);
+	//Seals the recording: the session ended on endTick in the given state
+	void Finish(Uint64 endTick, Uint32 checksum);
+	bool Save(const std::string& fileName) const;
+
+	//Playback
+	bool Load(const std::string& fileName);
+	//Next action due on (or before) tick, if any - call until it returns false
+	bool Next(Uint64 tick, Action& action);
+	__forceinline bool Ended(Uint64 tick) const { return tick >= endTick; }
+
+	__forceinline Mode GetMode() const { return mode; }
+	__forceinline bool IsRecording() const { return mode == M_Recording; }
+	__forceinline bool IsPlaying() const { return mode == M_Playing; }
+	__forceinline Uint64 Seed() const { return seed; }
+	__forceinline Uint64 EndTick() const { return endTick; }
+	__forceinline Uint32 Checksum() const { return checksum; }
+	__forceinline size_t Count() const { return entries.size(); }
+
+
+private:
+	struct Entry
+	{
+		Uint64 tick;
+		Action action;
+	};
+
+	std::vector<Entry> entries;
+	size_t cursor; //next to play
+	Uint64 seed;
+	Uint64 endTick;
+	Uint32 checksum;
+	Mode mode;
+};
+
+
+//FNV-1a, for state checksums
+class Checksum
+{
+public:
+	Checksum() : hash(2166136261u) {}
+
+	void Add(const void* data, size_t size)
+	{
+		const Uint8* bytes = static_cast<const Uint8*>(data);
+		for(size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 16777619u;
+	}
+
+	template<class T>
+	__forceinline void Add(const T& value) { Add(&value, sizeof(value)); }
+
+	__forceinline Uint32 Value() const { return hash; }
+
+private:
+	Uint32 hash;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+
+
+class GameObject;
+
+
+//Batched movement pass for moving objects (enemies)
+//The objects keep their own position and velocity (behaviour code reads and
+//writes them everywhere); this copies them in, moves, clamps to the ground and
+//sets depth (AdjustZToGameDepth) for all of them in one go, and copies back.
+//Rows are indexed by the object's kinematic id; awake ones come first, so
+//sleeping objects (SetAwake) cost nothing. Each tick, for the awake rows:
+//	Think()/Update() -> Gather() -> Integrate() -> WriteBack() -> GameObject::OnIntegrated()
+class Kinematics
+{
+public:
+	Kinematics(size_t initialCapacity = 64);
+
+	void Add(GameObject& object);
+	void Remove(GameObject& object);
+	void Clear();
+	__forceinline size_t Count() const { return owners.size(); }
+	__forceinline size_t Awake() const { return awake; }
+
+	//Sleeping objects are left out of the pass (they must not be moving)
+	//Added objects start awake
+	void SetAwake(GameObject& object, bool value);
+
+	//Copies every awake object's position and velocity in, once all behaviour has run
+	//(so nothing changed later in the tick is lost), with GameObject::Grounded():
+	//grounded ones stay on the floor (y clamped to the top of the play area) and
+	//get their depth from y. Objects in the air keep their depth
+	void Gather();
+
+	//Moves everything by its velocity, then applies the ground rules against groundTop
+	void Integrate(float groundTop);
+
+	//Copies the results back into the objects and calls OnIntegrated() on each
+	void WriteBack();
+
+
+private:
+	std::vector<float> x, y, z;
+	std::vector<float> xVel, yVel;
+	std::vector<Uint8> grounded;
+	std::vector<GameObject*> owners;
+	size_t awake; //rows [0, awake) are in the pass
+
+	void Swap(size_t a, size_t b);
+};
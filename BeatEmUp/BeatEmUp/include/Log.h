@@ -0,0 +1,217 @@
+#pragma once
+#include <SDL.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+//Log levels - anything below LOG_LEVEL is compiled out, arguments and all
+//Debug builds default to INFO (define LOG_LEVEL=0 for a verbose build), release to NONE
+#define LOG_LEVEL_TRACE	0
+#define LOG_LEVEL_DEBUG	1
+#define LOG_LEVEL_INFO	2
+#define LOG_LEVEL_WARN	3
+#define LOG_LEVEL_ERROR	4
+#define LOG_LEVEL_NONE	5
+
+#ifndef LOG_LEVEL
+#ifdef _DEBUG
+#define LOG_LEVEL	LOG_LEVEL_INFO
+#else
+#define LOG_LEVEL	LOG_LEVEL_NONE
+#endif
+#endif
+
+#define LOG_WRITE(level, ...)	Logger::Instance().Write(level, __VA_ARGS__)
+
+#if LOG_LEVEL <= LOG_LEVEL_TRACE
+#define logTrace(...)	LOG_WRITE(Logger::Trace, __VA_ARGS__)
+#else
+#define logTrace(...)	((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define logDebug(...)	LOG_WRITE(Logger::Debug, __VA_ARGS__)
+#else
+#define logDebug(...)	((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define logInfo(...)	LOG_WRITE(Logger::Info, __VA_ARGS__)
+#else
+#define logInfo(...)	((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define logWarn(...)	LOG_WRITE(Logger::Warn, __VA_ARGS__)
+#else
+#define logWarn(...)	((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define logError(...)	LOG_WRITE(Logger::Error, __VA_ARGS__)
+#else
+#define logError(...)	((void)0)
+#endif
+
+//General messages
+#define logPrintf(...)	logInfo(__VA_ARGS__)
+
+
+
+//Asynchronous logger
+//The logging thread only copies the format pointer and the arguments into a
+//slot of a lock-free ring buffer - no formatting, no locks, no I/O. A background
+//thread formats the records (printf rules) and writes them to stderr
+//When the ring is full, records are dropped (and counted) rather than waiting
+//Formats must be string literals (only the pointer is kept); string arguments
+//are copied, up to MaxStringBytes per record between them
+//Once the program is exiting, logging falls back to writing straight away
+class Logger
+{
+public:
+	enum Level
+	{
+		Trace, Debug, Info, Warn, Error
+	};
+
+	static Logger& Instance();
+
+	template<class... Args>
+	void Write(Level level, const char* format, Args... args)
+	{
+		if(!running)
+		{
+			Record record;
+			Fill(record, level, format, args...);
+			Output(record);
+			return;
+		}
+
+		size_t position;
+		Record* record = Acquire(position);
+		if(!record) return;
+		Fill(*record, level, format, args...);
+		record->sequence.store(position + 1, std::memory_order_release);
+
+		//Raced with Stop(): the consumer may have finished before this was published
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(!running) Drain();
+	}
+
+	//Waits until everything logged so far has been written
+	void Flush();
+
+	//Records lost to a full ring
+	__forceinline Uint64 Dropped() const { return dropped; }
+
+
+private:
+	static const size_t Capacity = 4096; //records, power of 2
+	static const size_t MaxArgs = 8;
+	static const size_t MaxStringBytes = 128;
+
+	enum ArgType : Uint8
+	{
+		A_Int, A_UInt, A_Long, A_ULong, A_LLong, A_ULLong, A_Double, A_String, A_Pointer
+	};
+
+	union Value
+	{
+		long long i;
+		unsigned long long u;
+		double d;
+		const void* p;
+		size_t offset; //into strings
+	};
+
+	struct Record
+	{
+		std::atomic<size_t> sequence; //ring slot state
+		const char* format;
+		Uint64 counter; //SDL_GetPerformanceCounter when logged
+		Uint8 level;
+		Uint8 argCount;
+		Uint16 stringBytes;
+		ArgType types[MaxArgs];
+		Value values[MaxArgs];
+		char strings[MaxStringBytes];
+	};
+
+	//Never destroyed - it has to outlive everything that logs from a destructor
+	Logger();
+	~Logger() = default;
+
+	Record* Acquire(size_t& position);
+	void Output(const Record& record);
+	void Consume();
+	void Stop();
+	void Drain(); //writes out what is left once the consumer has stopped
+
+	template<class... Args>
+	static void Fill(Record& record, Level level, const char* format, Args... args)
+	{
+		record.format = format;
+		record.counter = SDL_GetPerformanceCounter();
+		record.level = (Uint8)level;
+		record.argCount = 0;
+		record.stringBytes = 0;
+		Pack(record, args...);
+	}
+
+	static void Pack(Record&) {}
+
+	template<class T, class... Rest>
+	static void Pack(Record& record, T first, Rest... rest)
+	{
+		if(record.argCount < MaxArgs) Store(record, first);
+		Pack(record, rest...);
+	}
+
+	//One per printf argument kind (after the usual promotions)
+	static void Store(Record& r, int v) { Add(r, A_Int).i = v; }
+	static void Store(Record& r, unsigned int v) { Add(r, A_UInt).u = v; }
+	static void Store(Record& r, long v) { Add(r, A_Long).i = v; }
+	static void Store(Record& r, unsigned long v) { Add(r, A_ULong).u = v; }
+	static void Store(Record& r, long long v) { Add(r, A_LLong).i = v; }
+	static void Store(Record& r, unsigned long long v) { Add(r, A_ULLong).u = v; }
+	static void Store(Record& r, double v) { Add(r, A_Double).d = v; }
+	static void Store(Record& r, const void* v) { Add(r, A_Pointer).p = v; }
+	static void Store(Record& r, const char* v)
+	{
+		if(!v) v = "(null)";
+		//Out of room: the last byte is always a terminator
+		const size_t room = MaxStringBytes - r.stringBytes;
+		if(room == 0)
+		{
+			Add(r, A_String).offset = MaxStringBytes - 1;
+			return;
+		}
+		size_t length = strlen(v);
+		if(length >= room) length = room - 1;
+		memcpy(r.strings + r.stringBytes, v, length);
+		r.strings[r.stringBytes + length] = '\0';
+		Add(r, A_String).offset = r.stringBytes;
+		r.stringBytes += (Uint16)(length + 1);
+	}
+
+	static __forceinline Value& Add(Record& r, ArgType type)
+	{
+		r.types[r.argCount] = type;
+		return r.values[r.argCount++];
+	}
+
+	std::unique_ptr<Record[]> ring;
+	std::atomic<size_t> enqueuePos;
+	size_t dequeuePos; //background thread, then Drain() (under drainMutex)
+	std::mutex drainMutex;
+	std::atomic<size_t> written; //records done with (Flush)
+	std::atomic<Uint64> dropped;
+	std::atomic<bool> running;
+	std::thread thread;
+	const Uint64 epoch;
+	const double msPerCount;
+};
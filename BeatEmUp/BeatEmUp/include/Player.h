@@ -22,7 +22,8 @@ public:
 	Player(SDL_Renderer& renderer);
 	virtual ~Player();
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual RectF DrawBounds() const override { return current->Position(); }
 	virtual void SetDirection(Direction dir) override;
 	virtual void SetAngle(double theta) override;
 
@@ -35,8 +36,8 @@ public:
 	void Jump(float xAccel, float yAccel);
 	void Punch();
 	void Kick();
-	void OnHit(Uint8 damage = 1);
-	void KnockedDown();
+	virtual void OnHit(Uint8 damage = 1) override;
+	virtual void KnockedDown() override;
 	bool CantMove() const;
 	bool IsDown() const;
 
@@ -69,6 +70,10 @@ private:
 	Sprite::ptr fallRight;
 	Sprite::ptr kickLeft;
 	Sprite::ptr kickRight;
+	events::Token punchLeftToken; //FramePlayed subscriptions
+	events::Token punchRightToken;
+	events::Token kickLeftToken;
+	events::Token kickRightToken;
 	Sprite* current;
 
 	PlayerState pState;
@@ -0,0 +1,142 @@
+#pragma once
+#include <SDL.h>
+#include <atomic>
+#include <string>
+#include "Util.h"
+#include "Allocations.h"
+
+
+#define PROFILER	Profiler::Instance()
+
+//Times the enclosing scope into the given Profiler::Phase
+#define PROFILE_SCOPE(phase)	ProfileScope profileScope_(phase)
+
+
+
+//Lock-free single-producer ring buffer
+//The producer never blocks; once full, the oldest entries are overwritten
+//Readers copy out the most recent entries (Latest)
+template<typename T, size_t Capacity>
+class RingBuffer
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+	RingBuffer() : written(0) {}
+
+	void Push(const T& item)
+	{
+		const Uint64 n = written.load(std::memory_order_relaxed);
+		items[n & (Capacity - 1)] = item;
+		written.store(n + 1, std::memory_order_release);
+	}
+
+	//Number of items currently held
+	size_t Size() const
+	{
+		const Uint64 n = written.load(std::memory_order_acquire);
+		return n < Capacity? (size_t)n: Capacity;
+	}
+
+	//index 0 = most recent
+	const T& Latest(size_t index) const
+	{
+		const Uint64 n = written.load(std::memory_order_acquire);
+		return items[(n - 1 - index) & (Capacity - 1)];
+	}
+
+	//Total pushed since start
+	Uint64 Written() const { return written.load(std::memory_order_acquire); }
+
+private:
+	T items[Capacity];
+	std::atomic<Uint64> written;
+};
+
+
+
+//Per-frame phase profiler
+//Scoped high-resolution timers (PROFILE_SCOPE) accumulate into the current frame,
+//EndFrame() pushes it into a ring buffer holding the last FrameHistory frames
+class Profiler : public util::Singleton<Profiler>
+{
+public:
+	enum Phase
+	{
+		PH_Events,
+		PH_Update,
+		PH_Think,
+		PH_Sort,
+		PH_Cull,
+		PH_Draw,
+		PH_Present,
+		PH_Frame,
+		PH_Count
+	};
+
+	struct FrameSample
+	{
+		Uint64 frame;
+		Uint64 startUs[PH_Count];    //first entry into the phase (since profiler start)
+		Uint32 durationUs[PH_Count]; //total time spent in the phase during the frame
+		Uint32 allocs[PH_Count];     //heap allocations (any thread) while in the phase
+	};
+
+	//Rolling statistics (ms) for a phase
+	struct PhaseStats
+	{
+		float p50, p99, max;
+		float allocs; //mean per frame
+	};
+
+	static const size_t FrameHistory = 1024;
+
+	Profiler();
+
+	void BeginFrame();
+	void EndFrame();
+	void Record(Phase phase, Uint64 startCounter, Uint64 endCounter, Uint32 allocs = 0);
+
+	//Stats over the most recent (up to) frameCount frames
+	PhaseStats Stats(Phase phase, size_t frameCount = 240) const;
+
+	//Writes the frame history. ".json" files get Chrome trace format
+	//(chrome://tracing, Perfetto), anything else CSV
+	bool Export(const std::string& fileName) const;
+	bool ExportCSV(const std::string& fileName) const;
+	bool ExportTrace(const std::string& fileName) const;
+
+	static const char* PhaseName(Phase phase);
+
+private:
+	Uint64 ToMicroseconds(Uint64 counter) const;
+
+	RingBuffer<FrameSample, FrameHistory> frames;
+	FrameSample current;
+	Uint64 frameStart;
+	Uint64 frameAllocStart;
+	Uint64 frameCount;
+	const Uint64 epoch;
+	const double usPerCount;
+};
+
+
+
+//RAII phase timer - use PROFILE_SCOPE
+struct ProfileScope
+{
+	ProfileScope(Profiler::Phase phase_)
+		: phase(phase_)
+		, start(SDL_GetPerformanceCounter())
+		, allocStart(Allocations::Count())
+	{}
+
+	~ProfileScope()
+	{
+		PROFILER.Record(phase, start, SDL_GetPerformanceCounter(), (Uint32)(Allocations::Count() - allocStart));
+	}
+
+	const Profiler::Phase phase;
+	const Uint64 start;
+	const Uint64 allocStart;
+};
@@ -9,7 +9,8 @@ public:
 	Roamer(SDL_Renderer& renderer, Sprite::ptr walkLeftSprite, Sprite::ptr walkRightSprite
 		, float posX, float posY, float roamMinX_, float roamMaxX_, bool backgroundObj);
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual RectF DrawBounds() const override { return current->Position(); }
 	virtual ~Roamer();
 	virtual void SetDirection(Direction dir) override;
 	void Stop();
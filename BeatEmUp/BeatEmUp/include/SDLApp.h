@@ -2,6 +2,17 @@
 #include <SDL.h>
 #include <SDL_image.h>
 #include <string>
+#include <memory>
+#include "Workers.h"
+
+
+#define SIM_HZ_NORMAL			60
+#define SIM_HZ_SLOWMOTION	5
+
+//Fixed simulation rate (gameplay velocities are tuned per 60Hz tick)
+//Useful for testing/debugging
+//const int SIM_HZ = SIM_HZ_SLOWMOTION;
+const int SIM_HZ = SIM_HZ_NORMAL;
 
 
 class SDLApp
@@ -10,13 +21,24 @@ public:
 	SDLApp(const int clientWidth, const int clientHeight, const std::string& appTitle);
 	int Run();
 
+	//Headless mode - no window, GPU renderer or audio device
+	//Update() runs back-to-back at full CPU speed, Render() is never called
+	//tickLimit = 0 runs until quit
+	//Must be set before Init()
+	void SetHeadless(bool enabled, unsigned int tickLimit = 0);
+
 	virtual bool Init();
-	virtual void Update() = 0;
+	virtual void Update() = 0; //one fixed simulation step
 	virtual void Render() = 0;
 	virtual void ProcessEvent(const SDL_Event& e) = 0;
+	virtual float TimeScale() const { return 1.0f; } //simulation speed relative to real time
 	virtual ~SDLApp();
 
 	__forceinline float Fps() const { return fps_; }
+	__forceinline float Tps() const { return tps_; }
+	__forceinline bool IsHeadless() const { return headless_; }
+	//Render interpolation factor between the previous (0) and current (1) simulation state
+	__forceinline float Alpha() const { return alpha_; }
 	__forceinline unsigned int ClientWidth() const { return clientWidth_; }
 	__forceinline unsigned int ClientHeight() const { return clientHeight_; }
 
@@ -25,6 +47,7 @@ public:
 protected:
 	__forceinline SDL_Renderer& renderer() { return *renderer_; }
 	__forceinline SDL_Window& window() { return *window_; }
+	__forceinline Workers& workers() { return *workers_; }
 
 	const unsigned int clientWidth_;
 	const unsigned int clientHeight_;
@@ -33,7 +56,15 @@ protected:
 	bool fullScreen_;
 
 private:
+	int RunHeadless();
+
 	SDL_Renderer* renderer_;
 	SDL_Window* window_;
+	SDL_Surface* offscreen_; //headless render target
+	std::unique_ptr<Workers> workers_; //job system for frame tasks (see Workers)
 	float fps_;
+	float tps_; //simulation ticks per second
+	float alpha_;
+	bool headless_;
+	unsigned int tickLimit_;
 };
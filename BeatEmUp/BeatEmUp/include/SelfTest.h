@@ -0,0 +1,14 @@
+#pragma once
+
+
+//Self-checks (--selftest) of the pieces replays and benchmarks depend on:
+//PCG32 reference output, the input recording file round trip, event
+//subscription tokens, handle generations and ParallelFor covering its range
+//Each check prints a line; none of them needs the game to be initialised
+//(see Game::CheckDeterminism for the one that does)
+class SelfTest
+{
+public:
+	//Runs every check. Returns how many failed
+	static int Run();
+};
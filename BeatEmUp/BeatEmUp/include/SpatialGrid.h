@@ -0,0 +1,161 @@
+#pragma once
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include "GameObject.h"
+
+
+//Uniform grid (spatial hash) over the play area for proximity queries
+//The play area is a horizontal strip, so cells are columns cellWidth pixels wide
+//spanning the full depth; y/z are checked exactly on the few candidates
+//Columns are hashed into BucketCount buckets, so objects can be anywhere
+//(enemies wander well off screen). Objects sit in every column they overlap
+//Call Move() whenever an object's position changes - it only re-buckets
+//when the object crosses into a different column
+//NearestInXRange works from the positions recorded by Insert/Move, so it is
+//safe while the objects themselves are being updated (on worker threads)
+template<class T>
+class SpatialGrid
+{
+	static const size_t BucketCount = 64;
+	static_assert((BucketCount & (BucketCount - 1)) == 0, "BucketCount must be a power of 2");
+
+public:
+	SpatialGrid(float cellWidth_ = 128.0f) : cellWidth(cellWidth_) {}
+
+	void Insert(T* object)
+	{
+		const Span span = SpanOf(object->Position());
+		spans[object] = span;
+		Add(object, span);
+	}
+
+	void Remove(T* object)
+	{
+		auto it = spans.find(object);
+		if(it == spans.end()) return;
+		Erase(object, it->second);
+		spans.erase(it);
+	}
+
+	void Move(T* object)
+	{
+		auto it = spans.find(object);
+		if(it == spans.end()) return;
+
+		const Span span = SpanOf(object->Position());
+		if(span.first != it->second.first || span.last != it->second.last)
+		{
+			Erase(object, it->second);
+			Add(object, span);
+		}
+		it->second = span;
+	}
+
+	void Clear()
+	{
+		for(auto& bucket : buckets) bucket.clear();
+		spans.clear();
+	}
+
+	__forceinline size_t Count() const { return spans.size(); }
+
+
+	//Calls fn(T*) once for every object overlapping [left, right] in x (candidates only)
+	template<class Fn>
+	void ForEachInXRange(float left, float right, Fn fn) const
+	{
+		const int first = Column(left), last = Column(right);
+		for(int column = first; column <= last; ++column)
+		{
+			for(const Cell& cell : buckets[Bucket(column)])
+			{
+				//Other columns hashed to this bucket, or reported in an earlier column
+				if(column < cell.first || column > cell.last) continue;
+				if(column != SDL_max(cell.first, first)) continue;
+				fn(cell.object);
+			}
+		}
+	}
+
+
+	//Calls fn(T*) for every object other than self that self collides with
+	//(GameObject::CollidedWith, same thresholds)
+	template<class Fn>
+	void ForEachOverlapping(const GameObject& self, Fn fn
+		, const int penThresholdX = 25, const int penThresholdY = 25, const int penThresholdZ = 25) const
+	{
+		//Anything colliding overlaps the rect shrunk by the x threshold
+		const RectF& rect = self.Position();
+		const float a = rect.left() + penThresholdX, b = rect.right() - penThresholdX;
+		ForEachInXRange(SDL_min(a, b), SDL_max(a, b), [&](T* object)
+		{
+			if(object != &self && self.CollidedWith(*object, penThresholdX, penThresholdY, penThresholdZ))
+				fn(object);
+		});
+	}
+
+
+	//Closest object (by centre) other than self whose x extent overlaps self's
+	T* NearestInXRange(const GameObject& self) const
+	{
+		const RectF& rect = self.Position();
+		const float centre = rect.x + rect.w / 2.0f;
+		T* nearest = nullptr;
+		float nearestDist = 0.0f;
+		ForEachInXRange(rect.left(), rect.right(), [&](T* object)
+		{
+			const RectF& other = spans.find(object)->second.rect;
+			if(object == &self || rect.right() < other.left() || rect.left() > other.right()) return;
+
+			const float dist = std::fabs(other.x + other.w / 2.0f - centre);
+			if(!nearest || dist < nearestDist) nearest = object, nearestDist = dist;
+		});
+		return nearest;
+	}
+
+
+private:
+	struct Span
+	{
+		int first, last; //columns
+		RectF rect; //position when last inserted/moved
+	};
+
+	struct Cell
+	{
+		T* object;
+		int first, last;
+	};
+
+	__forceinline int Column(float x) const { return (int)std::floor(x / cellWidth); }
+	__forceinline size_t Bucket(int column) const { return (size_t)(unsigned)column & (BucketCount - 1); }
+	__forceinline Span SpanOf(const RectF& rect) const { return Span{ Column(rect.left()), Column(rect.right()), rect }; }
+
+	void Add(T* object, const Span& span)
+	{
+		for(int column = span.first; column <= span.last; ++column)
+			buckets[Bucket(column)].push_back(Cell{ object, span.first, span.last });
+	}
+
+	void Erase(T* object, const Span& span)
+	{
+		for(int column = span.first; column <= span.last; ++column)
+		{
+			auto& bucket = buckets[Bucket(column)];
+			for(size_t i = 0; i < bucket.size(); ++i)
+			{
+				if(bucket[i].object == object)
+				{
+					bucket[i] = bucket.back();
+					bucket.pop_back();
+					break;
+				}
+			}
+		}
+	}
+
+	const float cellWidth;
+	std::vector<Cell> buckets[BucketCount];
+	std::unordered_map<const T*, Span> spans;
+};
@@ -2,6 +2,7 @@
 #include "GameObject.h"
 #include "Mixer.h"
 #include "CppEvent.h"
+#include "Assets.h"
 #include <memory>
 #include "Util.h"
 
@@ -10,11 +11,12 @@ class Sprite : public GameObject
 {
 
 public:
-	Sprite(SDL_Surface* const spriteSheet, SDL_Renderer& renderer, 
+	Sprite(const TextureRef& spriteSheet, 
 		int frameWidth, int frameHeight, int frameSpeed_, int stillFrame_, bool playReverse = false);
 
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	void Draw(SpriteBatch& batch, const RectF& dest) const; //draw current frame at dest
 	virtual ~Sprite();
 
 	//Getters
@@ -44,19 +46,30 @@ public:
 
 	events::Event<const Sprite&, const FramePlayedEventArgs&> FramePlayed;
 
-	using ptr = unique_ptr<Sprite>;
+	typedef void(*Deleter) (Sprite*);
+	using ptr = unique_ptr<Sprite, Deleter>;
 
+	//Comes from the current arena (see World) when there is one, otherwise the heap
 	static inline Sprite::ptr FromFile(string filename, SDL_Renderer& renderer, 
 		int frameWidth, int frameHeight, int frameSpeed, int stillFrame, bool playReverse = false
 		, Uint8 colKeyR = 0x00, Uint8 colKeyG = 0x00, Uint8 colKeyB = 0x00)
 	{
-		util::SDLSurfaceFromFile surface(filename, true, colKeyR, colKeyG, colKeyB);
-		return std::make_unique<Sprite>(surface.surface, renderer, frameWidth, frameHeight, frameSpeed, stillFrame, playReverse);
+		//Sheets are shared between all sprites using the same file (and colour key)
+		const TextureRef sheet(ASSETS.Texture(filename, renderer, true, colKeyR, colKeyG, colKeyB));
+		Arena* arena = Arena::Current();
+		if(arena)
+		{
+			return Sprite::ptr(arena->New<Sprite>(sheet, frameWidth, frameHeight, frameSpeed, stillFrame, playReverse)
+				, [](Sprite* s) { s->~Sprite(); });
+		}
+		return Sprite::ptr(new Sprite(sheet, frameWidth, frameHeight, frameSpeed, stillFrame, playReverse)
+			, [](Sprite* s) { delete s; });
 	}
 
 
 private:
-	unique_ptr2<SDL_Texture> sheet;
+	shared_ptr<SDL_Texture> sheet;
+	SDL_Rect region; //where the sheet is within the texture
 	int framesPerRow;
 	int rowCount;
 	int currentFrame;
@@ -0,0 +1,70 @@
+#pragma once
+#include <SDL.h>
+#include <vector>
+#include "Util.h"
+
+
+//SDL_RenderGeometry (one call for a whole run of quads) came with SDL 2.0.18
+#define SPRITEBATCH_GEOMETRY	SDL_VERSION_ATLEAST(2, 0, 18)
+
+
+//Batches textured quads and submits them with as few draw calls as possible
+//Quads are drawn in submission order (painter's algorithm), so consecutive quads
+//from the same texture (e.g. the sprite atlas) go out as one SDL_RenderGeometry call
+//Dest rects are snapped to whole pixels (as SDL_RenderCopy would), so nothing
+//shimmers as it moves by fractions of a pixel
+//Built against SDL older than 2.0.18 there is no SDL_RenderGeometry: quads then
+//go out one SDL_RenderCopy each (SDL_RenderCopyEx only when rotated), setting
+//the colour mod only when it changes (same output, no batching)
+class SpriteBatch
+{
+public:
+	SpriteBatch(SDL_Renderer& renderer, size_t initialCapacity = 1024);
+
+	//Queues src of texture drawn at dest
+	//angle in degrees, clockwise around the centre of dest (as SDL_RenderCopyEx)
+	void Draw(SDL_Texture* texture, const SDL_Rect& src, const util::RectF& dest, double angle = 0.0);
+	void Draw(SDL_Texture* texture, const SDL_Rect& src, const util::RectF& dest, double angle, const SDL_Colour& colour);
+
+	//Submits everything queued
+	void Flush();
+
+	//Added to dest of every quad drawn from now on (world to screen)
+	__forceinline void SetTranslation(float x, float y) { translateX = x, translateY = y; }
+
+	//Dry run: quads (and vertices) are prepared as usual but never handed to
+	//the renderer - benchmarks time draw preparation on its own with this
+	__forceinline void SetDryRun(bool enabled) { dryRun = enabled; }
+
+	//For anything that has to draw directly (Flush first)
+	__forceinline SDL_Renderer& Renderer() { return renderer; }
+
+	//Stats since the last ResetStats()
+	__forceinline size_t DrawCalls() const { return drawCalls; }
+	__forceinline size_t Quads() const { return quads; }
+	__forceinline void ResetStats() { drawCalls = quads = 0; }
+
+
+private:
+	struct Quad
+	{
+		SDL_Rect src;
+		util::RectF dest;
+		double angle;
+		SDL_Colour colour;
+	};
+
+	void Submit();
+
+	SDL_Renderer& renderer;
+	SDL_Texture* texture; //texture of the pending run
+	std::vector<Quad> pending;
+#if SPRITEBATCH_GEOMETRY
+	std::vector<SDL_Vertex> vertices;
+	std::vector<int> indices;
+#endif
+	float translateX, translateY;
+	bool dryRun;
+	size_t drawCalls;
+	size_t quads;
+};
@@ -1,19 +1,26 @@
 #pragma once
 #include "GameObject.h"
-#include <SDL_ttf.h>
+#include "Font.h"
 #include <memory>
 
 
+//A line of text drawn from a shared glyph atlas
+//Size is re-measured only when the text changes
+//Without SDL_RenderGeometry (see SpriteBatch) a quad per glyph would be a draw
+//call per glyph, so there the whole line is cached as one texture instead,
+//rebuilt when the text or colour changes
 class TextBlock : public GameObject
 {
 public:
 	TextBlock(const string& text_, size_t size, float x, float y, SDL_Renderer& renderer);
 	virtual ~TextBlock();
 	virtual void Update() override;
-	virtual void Draw(SDL_Renderer& renderer) const override;
+	virtual void Draw(SpriteBatch& batch) const override;
+	virtual bool ScreenSpace() const override { return true; }
 
 	__forceinline string GetText() const { return text; }
-	__forceinline void SetText(const string& txt) { text = txt; }
+	void SetText(const string& txt);
+	void SetText(const char* txt); //reuses the string's storage, no allocation once it is big enough
 	__forceinline const SDL_Colour& GetColour() const { return colour; }
 	
 	__forceinline void SetColour(Uint8 r_, Uint8 g_, Uint8 b_, Uint8 a_)
@@ -26,7 +33,17 @@ public:
 
 
 private:
-	unique_ptr<TTFont> font;
+	shared_ptr<const GlyphAtlas> font;
 	string text;
 	SDL_Colour colour;
+
+#if !SPRITEBATCH_GEOMETRY
+	void Rasterise() const;
+
+	unique_ptr<TTFont> ttf;
+	SDL_Renderer& renderer;
+	mutable shared_ptr<SDL_Texture> line; //text as last rasterised
+	mutable string lineText;
+	mutable SDL_Colour lineColour;
+#endif
 };
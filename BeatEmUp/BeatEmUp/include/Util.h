@@ -6,14 +6,9 @@
 #include <SDL_ttf.h>
 #include <memory>
 #include <functional>
+#include "Log.h"
 
 
-#ifdef _DEBUG
-#define logPrintf(fmt, ...)	fprintf(stderr, fmt "\n", __VA_ARGS__)
-#else
-#define logPrintf()
-#endif
-
 #define __WHEEL	util::Random::Instance()
 
 
@@ -83,32 +78,91 @@ namespace util
 	}
 
 
-	//Singleton pseudo-random number generator
+	//Random numbers - PCG32 (permuted congruential generator, www.pcg-random.org)
+	//The same seed and stream always give the same numbers, on any platform
+	//__WHEEL is the shared generator (main thread only); objects drawing numbers
+	//anywhere else own a generator of their own, on its own stream (see Fork)
 	struct Random : public Singleton<Random>
 	{
+		//Seeded from the clock - Seed() it for reproducible runs
 		Random()
 		{
-			srand((unsigned int)time(nullptr));
+			Seed((Uint64)time(nullptr));
+		}
+
+		explicit Random(Uint64 seed, Uint64 stream = 0)
+		{
+			Seed(seed, stream);
+		}
+
+		//Different streams are independent sequences, even from the same seed
+		void Seed(Uint64 seed_, Uint64 stream = 0)
+		{
+			seed = seed_;
+			state = 0;
+			increment = (stream << 1) | 1;
+			NextU32();
+			state += seed;
+			NextU32();
+		}
+
+		__forceinline Uint64 GetSeed() const { return seed; }
+
+		//A generator on a stream of its own, seeded from this one
+		Random Fork()
+		{
+			const Uint64 hi = NextU32();
+			const Uint64 lo = NextU32();
+			const Uint64 streamHi = NextU32();
+			const Uint64 streamLo = NextU32();
+			return Random(hi << 32 | lo, streamHi << 32 | streamLo);
+		}
+
+		__forceinline Uint32 NextU32()
+		{
+			const Uint64 old = state;
+			state = old * 6364136223846793005ULL + increment;
+			const Uint32 xorshifted = (Uint32)(((old >> 18) ^ old) >> 27);
+			const Uint32 rot = (Uint32)(old >> 59);
+			return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+		}
+
+		//[0, bound) with no modulo bias (Lemire: multiply, reject the short end)
+		__forceinline Uint32 Below(const Uint32 bound)
+		{
+			Uint64 m = (Uint64)NextU32() * bound;
+			if((Uint32)m < bound)
+			{
+				const Uint32 threshold = (0u - bound) % bound;
+				while((Uint32)m < threshold)
+					m = (Uint64)NextU32() * bound;
+			}
+			return (Uint32)(m >> 32);
 		}
 
 		//Note: max is EXCLUSIVE
-		__forceinline unsigned long Next(const int min, const int max) const
+		__forceinline int Next(const int min, const int max)
 		{
-			int r = rand();
-			return min + r % (max - min);
+			if(max <= min) return min;
+			return (int)((Sint64)min + Below((Uint32)((Sint64)max - min)));
 		}
 
 		//Note: max is EXCLUSIVE
-		__forceinline float Next(const float min, const float max) const
+		__forceinline float Next(const float min, const float max)
 		{
-			float r = (float)rand() / (float)RAND_MAX;
+			const float r = (NextU32() >> 8) * (1.0f / 16777216.0f); //24 bits, [0, 1)
 			return min + r * (max - min);
 		}
 
-		__forceinline bool TakeAChance() const
+		__forceinline bool TakeAChance()
 		{
-			return Next(0, 2) > 0;
+			return (NextU32() >> 31) != 0;
 		}
+
+	private:
+		Uint64 state;
+		Uint64 increment; //stream (odd)
+		Uint64 seed;
 	};
 
 
@@ -154,6 +208,10 @@ namespace util
 	}
 
 	
+	//32-bit RGBA surface (R,G,B,A byte order in memory), fully transparent
+	SDL_Surface* CreateRGBASurface(int width, int height);
+
+
 	//RAII for SDL_Surface objects
 	struct SDLSurfaceFromFile
 	{
@@ -178,7 +236,7 @@ namespace util
 			font = TTF_OpenFont(fileName.c_str(), size);
 			if(!font)
 			{
-				logPrintf("Unable to open {%s}  ERROR: %s", fileName.c_str(), TTF_GetError());
+				logError("Unable to open {%s}  ERROR: %s", fileName.c_str(), TTF_GetError());
 			}
 		}
 
@@ -189,7 +247,7 @@ namespace util
 			{
 				TTF_CloseFont(font);
 				font = nullptr;
-				logPrintf("TTFont object released");
+				logTrace("TTFont object released");
 			}
 		}
 	};
@@ -206,12 +264,12 @@ namespace util
 		{
 			if(!surface)
 			{
-				logPrintf( "TextTexture ERROR: %s", TTF_GetError() );
+				logError( "TextTexture ERROR: %s", TTF_GetError() );
 			}
 
 			if(!texture)
 			{
-				logPrintf( "TextTexture ERROR: %s", SDL_GetError() );
+				logError( "TextTexture ERROR: %s", SDL_GetError() );
 			}
 		}
 
@@ -0,0 +1,116 @@
+#pragma once
+#include <SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//Work-stealing task scheduler
+//Every thread (the owning/main thread is number 0) has its own queue of tasks,
+//used as a deque: it pushes and pops at the back (newest first, still warm in
+//cache), idle threads steal from the front of somebody else's (oldest, usually
+//the biggest piece of work left). The queues are plain vectors behind a mutex
+//each - the locks are per queue and held for a push/pop only, and batches
+//(ParallelFor, released continuations) go in under one lock with one wake-up
+//Workers sleep when there is nothing queued anywhere; Wait() helps with queued
+//tasks, then sleeps until its group is done
+//Tasks are grouped in TaskGroups, which can be waited on or run after
+//Only the main thread may Wait(); any task may Run() more tasks
+class Workers
+{
+public:
+	typedef std::function<void()> Task;
+
+	//Counts the unfinished tasks put in it
+	//Tasks can also be held back until another group is done (see Run)
+	class TaskGroup
+	{
+	public:
+		TaskGroup() : pending(0) {}
+		__forceinline bool Done() const { return pending == 0; }
+
+	private:
+		friend class Workers;
+		struct Deferred
+		{
+			Task task;
+			TaskGroup* group;
+		};
+
+		std::atomic<size_t> pending;
+		std::mutex mutex;
+		std::vector<Deferred> continuations; //waiting for this group
+	};
+
+	//Per-thread counters (since start or the last ResetStats)
+	struct Stats
+	{
+		Uint64 tasks;			//tasks run
+		Uint64 steals;			//of those, taken from another thread's deque
+		Uint64 failedSteals;	//sweeps over the other deques that found nothing
+		Uint64 idleUs;			//time spent asleep (workers) or waiting for others (main thread)
+	};
+
+
+	//threadCount 0 = one less than the number of cores (the caller is the other one)
+	explicit Workers(unsigned int threadCount = 0);
+	~Workers();
+
+	//Queues task in group. Given after, the task is only queued once
+	//everything in after is done (all of after's tasks must be in it already)
+	void Run(TaskGroup& group, Task task, TaskGroup* after = nullptr);
+
+	//Runs queued tasks (anybody's) until everything in group is done
+	void Wait(TaskGroup& group);
+
+	//Runs fn(begin, end) over [0, count) in chunks of up to grain items, as
+	//tasks the other threads steal. Returns once every chunk is done
+	void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+
+	__forceinline unsigned int ThreadCount() const { return (unsigned int)threads.size(); }
+
+	//thread 0 is the main thread, 1..ThreadCount() the workers
+	Stats GetStats(unsigned int thread) const;
+	Stats TotalStats() const;
+	void ResetStats();
+	void LogStats() const;
+
+
+private:
+	struct Queue
+	{
+		Queue();
+		std::mutex mutex;
+		//Deque as a vector: the owner works at the back, thieves take from
+		//head. Storage is reused once it empties, so steady state never allocates
+		std::vector<TaskGroup::Deferred> tasks;
+		size_t head;
+
+		std::atomic<Uint64> tasksRun;
+		std::atomic<Uint64> steals;
+		std::atomic<Uint64> failedSteals;
+		std::atomic<Uint64> idleUs;
+	};
+
+	void WorkerMain(unsigned int self);
+	void Push(unsigned int self, TaskGroup::Deferred* deferred, size_t count);
+	void Signal(size_t count); //count tasks were queued
+	bool Pop(unsigned int self, TaskGroup::Deferred& out);
+	bool Steal(unsigned int self, TaskGroup::Deferred& out);
+	bool RunOne(unsigned int self);
+	void Finish(unsigned int self, TaskGroup& group);
+	unsigned int Self() const;
+
+	std::vector<std::thread> threads;
+	std::vector<std::unique_ptr<Queue>> queues; //one per thread, main thread first
+
+	std::mutex sleepMutex;
+	std::condition_variable wake; //workers: something queued (or stop)
+	std::condition_variable finished; //Wait(): a group finished, or something queued
+	std::atomic<size_t> queued; //tasks sitting in deques
+	bool stop;
+};
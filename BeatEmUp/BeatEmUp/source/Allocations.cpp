@@ -0,0 +1,141 @@
+#include "Allocations.h"
+#include "Util.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+
+//Nothing here may allocate (or log from inside operator new)
+static std::atomic<Uint64> allocCount(0);
+static std::atomic<Uint64> allocBytes(0);
+static std::atomic<Uint64> freeCount(0);
+
+static const char* const Untagged = "(untagged)";
+static const char* const OtherTags = "(other tags)";
+static thread_local const char* currentTag = nullptr;
+static std::atomic<bool> tagsEnabled(false);
+
+struct TagSlot
+{
+	std::atomic<const char*> tag;
+	std::atomic<Uint64> count;
+	std::atomic<Uint64> bytes;
+};
+static TagSlot tagSlots[Allocations::MaxTags]; //the last one takes whatever does not fit
+
+static std::atomic<bool> expectNone(false);
+static std::atomic<Uint64> violations(0);
+static std::atomic<const char*> lastViolation(nullptr);
+
+
+Uint64 Allocations::Count() { return allocCount; }
+Uint64 Allocations::Bytes() { return allocBytes; }
+Uint64 Allocations::Frees() { return freeCount; }
+
+
+void Allocations::EnableTags(bool enabled)
+{
+	tagsEnabled = enabled;
+}
+
+
+const char* Allocations::SetTag(const char* tag)
+{
+	const char* previous = currentTag;
+	currentTag = tag;
+	return previous;
+}
+
+
+//Tags are told apart by pointer (literals), slots claimed first come first served
+static TagSlot& SlotFor(const char* tag)
+{
+	const size_t Last = Allocations::MaxTags - 1;
+	for(size_t i = 0; i < Last; ++i)
+	{
+		TagSlot& slot = tagSlots[i];
+		const char* current = slot.tag.load(std::memory_order_acquire);
+		if(!current && slot.tag.compare_exchange_strong(current, tag)) return slot;
+		if(current == tag) return slot;
+	}
+	tagSlots[Last].tag = OtherTags;
+	return tagSlots[Last];
+}
+
+
+size_t Allocations::Tags(TagStats* out, size_t max)
+{
+	TagStats all[MaxTags];
+	size_t n = 0;
+	for(const TagSlot& slot : tagSlots)
+	{
+		const char* tag = slot.tag.load(std::memory_order_acquire);
+		if(tag) all[n++] = TagStats{ tag, slot.count, slot.bytes };
+	}
+	std::sort(all, all + n, [](const TagStats& a, const TagStats& b) { return a.count > b.count; });
+
+	n = SDL_min(n, max);
+	std::copy(all, all + n, out);
+	return n;
+}
+
+
+void Allocations::LogTags()
+{
+	TagStats tags[MaxTags];
+	const size_t n = Tags(tags, MaxTags);
+	logPrintf("Allocations: %llu (%llu bytes), %llu frees", (unsigned long long)Count()
+		, (unsigned long long)Bytes(), (unsigned long long)Frees());
+	for(size_t i = 0; i < n; ++i)
+		logPrintf("  %-24s %10llu allocs %12llu bytes", tags[i].tag
+			, (unsigned long long)tags[i].count, (unsigned long long)tags[i].bytes);
+}
+
+
+bool Allocations::ExpectNone(bool enabled)
+{
+	return expectNone.exchange(enabled);
+}
+
+
+Uint64 Allocations::Violations() { return violations; }
+const char* Allocations::LastViolation() { return lastViolation; }
+
+
+static void* Allocate(size_t size)
+{
+	allocCount.fetch_add(1, std::memory_order_relaxed);
+	allocBytes.fetch_add(size, std::memory_order_relaxed);
+
+	if(tagsEnabled.load(std::memory_order_relaxed))
+	{
+		TagSlot& slot = SlotFor(currentTag? currentTag: Untagged);
+		slot.count.fetch_add(1, std::memory_order_relaxed);
+		slot.bytes.fetch_add(size, std::memory_order_relaxed);
+	}
+
+	if(expectNone.load(std::memory_order_relaxed))
+	{
+		violations.fetch_add(1, std::memory_order_relaxed);
+		lastViolation = currentTag? currentTag: Untagged;
+	}
+
+	void* p = std::malloc(size? size: 1);
+	if(!p) throw std::bad_alloc();
+	return p;
+}
+
+
+static void Free(void* p)
+{
+	if(!p) return;
+	freeCount.fetch_add(1, std::memory_order_relaxed);
+	std::free(p);
+}
+
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* p) noexcept { Free(p); }
+void operator delete[](void* p) noexcept { Free(p); }
@@ -0,0 +1,64 @@
+#include "Arena.h"
+#include "Util.h"
+
+
+Arena* Arena::current = nullptr;
+
+
+Arena::Arena(size_t blockSize_)
+	: blockSize(blockSize_)
+	, block(0)
+	, offset(0)
+	, used(0)
+{
+}
+
+
+void* Arena::Allocate(size_t size, size_t alignment)
+{
+	for(;;)
+	{
+		if(block < blocks.size())
+		{
+			Block& b = blocks[block];
+			const size_t start = (offset + alignment - 1) & ~(alignment - 1);
+			if(start + size <= b.size)
+			{
+				offset = start + size;
+				used += size;
+				return b.data.get() + start;
+			}
+
+			//Doesn't fit - on to the next block
+			++block, offset = 0;
+			continue;
+		}
+
+		//Out of blocks (big objects get a block of their own)
+		Block b;
+		b.size = SDL_max(blockSize, size + alignment);
+		b.data.reset(new char[b.size]);
+		blocks.push_back(std::move(b));
+		logTrace("Arena: block %lu (%lu bytes)", (unsigned long)blocks.size(), (unsigned long)blocks.back().size);
+	}
+}
+
+
+void Arena::Reset()
+{
+	block = 0, offset = 0, used = 0;
+}
+
+
+size_t Arena::Capacity() const
+{
+	size_t capacity = 0;
+	for(const Block& b : blocks) capacity += b.size;
+	return capacity;
+}
+
+
+Arena* Arena::Current()
+{
+	return current;
+}
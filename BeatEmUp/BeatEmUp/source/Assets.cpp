@@ -0,0 +1,222 @@
+#include "Assets.h"
+#include "Font.h"
+#include <stdio.h>
+#include <algorithm>
+#include <numeric>
+
+
+using namespace std;
+using namespace util;
+
+
+//Upper bound for atlas pages (further limited by the renderer)
+const int AtlasPageSize = 2048;
+
+
+AssetRegistry::AssetRegistry()
+	: loads(0)
+	, hits(0)
+{
+}
+
+
+AssetRegistry::~AssetRegistry()
+{
+	ReleaseAtlas();
+	logPrintf("AssetRegistry released. %lu loads, %lu hits", (unsigned long)loads, (unsigned long)hits);
+}
+
+
+string AssetRegistry::Key(const string& file, bool transparent, Uint8 r, Uint8 g, Uint8 b)
+{
+	if(!transparent) return file;
+
+	char colourKey[16];
+	snprintf(colourKey, sizeof(colourKey), "|%02x%02x%02x", r, g, b);
+	return file + colourKey;
+}
+
+
+TextureRef AssetRegistry::Texture(const string& file, SDL_Renderer& renderer, bool transparent
+	, Uint8 colKeyR, Uint8 colKeyG, Uint8 colKeyB)
+{
+	TextureRef ref;
+	const string key(Key(file, transparent, colKeyR, colKeyG, colKeyB));
+
+	//Packed in the atlas?
+	auto at = atlas.find(key);
+	if(at != atlas.end())
+	{
+		ref.texture = pages[at->second.page];
+		ref.rect = at->second.rect;
+		++hits;
+		return ref;
+	}
+
+	//Already loaded and still in use?
+	auto it = textures.find(key);
+	if(it != textures.end())
+	{
+		ref.texture = it->second.texture.lock();
+		if(ref.texture)
+		{
+			ref.rect.w = it->second.w, ref.rect.h = it->second.h;
+			++hits;
+			return ref;
+		}
+	}
+
+	//Decode and upload
+	SDLSurfaceFromFile surface(file, transparent, colKeyR, colKeyG, colKeyB);
+	if(!surface.surface) return ref;
+
+	ref.texture = shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(&renderer, surface.surface)
+		, [](SDL_Texture* p) { if(p) SDL_DestroyTexture(p); });
+	if(!ref.texture.get())
+	{
+		logError("Unable to create texture from %s! SDL Error: %s", file.c_str(), SDL_GetError());
+		ref.texture.reset();
+		return ref;
+	}
+
+	ref.rect.w = surface.surface->w, ref.rect.h = surface.surface->h;
+	Entry& entry = textures[key];
+	entry.texture = ref.texture;
+	entry.w = ref.rect.w, entry.h = ref.rect.h;
+	++loads;
+	return ref;
+}
+
+
+shared_ptr<const GlyphAtlas> AssetRegistry::Font(const string& file, int size, SDL_Renderer& renderer)
+{
+	char sizeKey[16];
+	snprintf(sizeKey, sizeof(sizeKey), "@%d", size);
+	const string key(file + sizeKey);
+
+	auto& entry = fonts[key];
+	shared_ptr<const GlyphAtlas> font = entry.lock();
+	if(font)
+	{
+		++hits;
+		return font;
+	}
+
+	font = make_shared<GlyphAtlas>(file, size, renderer);
+	entry = font;
+	++loads;
+	return font;
+}
+
+
+void AssetRegistry::BuildAtlas(SDL_Renderer& renderer, const AtlasImage* images, size_t count)
+{
+	ReleaseAtlas();
+
+	//Page size - as big as the renderer allows, up to AtlasPageSize
+	int pageSize = AtlasPageSize;
+	SDL_RendererInfo info;
+	if(SDL_GetRendererInfo(&renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0)
+	{
+		pageSize = SDL_min(pageSize, SDL_min(info.max_texture_width, info.max_texture_height));
+	}
+
+	//Decode everything (colour keys applied)
+	vector<unique_ptr<SDLSurfaceFromFile>> surfaces;
+	surfaces.reserve(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		surfaces.push_back(make_unique<SDLSurfaceFromFile>(images[i].file, true
+			, images[i].colKeyR, images[i].colKeyG, images[i].colKeyB));
+	}
+
+	//Tallest first packs best on shelves
+	vector<size_t> order(count);
+	iota(order.begin(), order.end(), 0);
+	sort(order.begin(), order.end(), [&](size_t a, size_t b)
+	{
+		const int ha = surfaces[a]->surface? surfaces[a]->surface->h: 0;
+		const int hb = surfaces[b]->surface? surfaces[b]->surface->h: 0;
+		return ha > hb;
+	});
+
+	//Place
+	const size_t NotPacked = (size_t)-1;
+	vector<AtlasEntry> placed(count);
+	vector<int> pageHeights(1, 0);
+	AtlasPacker packer(pageSize, pageSize);
+	for(const size_t i : order)
+	{
+		placed[i].page = NotPacked;
+		const SDL_Surface* surface = surfaces[i]->surface;
+		if(!surface) continue;
+
+		if(!packer.Insert(surface->w, surface->h, placed[i].rect))
+		{
+			//Page full - next page (unless it won't fit any page)
+			if(pageHeights.back() == 0) continue;
+			pageHeights.push_back(0);
+			packer.Reset();
+			if(!packer.Insert(surface->w, surface->h, placed[i].rect)) continue;
+		}
+
+		placed[i].page = pageHeights.size() - 1;
+		pageHeights.back() = packer.UsedHeight();
+	}
+
+	//Compose and upload the pages
+	for(size_t page = 0; page < pageHeights.size() && pageHeights[page] > 0; ++page)
+	{
+		unique_ptr2<SDL_Surface> canvas(CreateRGBASurface(pageSize, pageHeights[page])
+			, [](SDL_Surface* s) { if(s) SDL_FreeSurface(s); });
+		if(!canvas) break;
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			if(placed[i].page != page) continue;
+			//Copy as is (colour keyed pixels are skipped, leaving them transparent)
+			SDL_SetSurfaceBlendMode(surfaces[i]->surface, SDL_BLENDMODE_NONE);
+			SDL_Rect dest = placed[i].rect;
+			SDL_BlitSurface(surfaces[i]->surface, nullptr, canvas.get(), &dest);
+		}
+
+		shared_ptr<SDL_Texture> texture(SDL_CreateTextureFromSurface(&renderer, canvas.get())
+			, [](SDL_Texture* p) { if(p) SDL_DestroyTexture(p); });
+		if(!texture.get())
+		{
+			logError("Unable to create atlas texture! SDL Error: %s", SDL_GetError());
+			break;
+		}
+		SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+		pages.push_back(texture);
+		logPrintf("Atlas page %lu: %dx%d", (unsigned long)page, pageSize, pageHeights[page]);
+	}
+
+	//Register whatever made it into an uploaded page
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(placed[i].page >= pages.size()) continue;
+		atlas[Key(images[i].file, true, images[i].colKeyR, images[i].colKeyG, images[i].colKeyB)] = placed[i];
+	}
+
+	logPrintf("Atlas built: %lu of %lu images in %lu page(s)"
+		, (unsigned long)atlas.size(), (unsigned long)count, (unsigned long)pages.size());
+}
+
+
+void AssetRegistry::ReleaseAtlas()
+{
+	atlas.clear();
+	pages.clear();
+}
+
+
+size_t AssetRegistry::Live() const
+{
+	size_t count = pages.size();
+	for(const auto& entry : textures)
+	{
+		if(!entry.second.texture.expired()) ++count;
+	}
+	return count;
+}
@@ -0,0 +1,39 @@
+#include "Atlas.h"
+
+
+AtlasPacker::AtlasPacker(int width_, int height_, int padding_)
+	: width(width_)
+	, height(height_)
+	, padding(padding_)
+{
+	Reset();
+}
+
+
+void AtlasPacker::Reset()
+{
+	shelfX = shelfY = shelfHeight = 0;
+}
+
+
+bool AtlasPacker::Insert(int w, int h, SDL_Rect& placed)
+{
+	const int pw = w + padding;
+	const int ph = h + padding;
+	if(pw > width || ph > height) return false;
+
+	//Current shelf full - start a new one
+	if(shelfX + pw > width)
+	{
+		shelfY += shelfHeight;
+		shelfX = shelfHeight = 0;
+	}
+
+	if(shelfY + ph > height) return false;
+
+	placed.x = shelfX, placed.y = shelfY;
+	placed.w = w, placed.h = h;
+	shelfX += pw;
+	shelfHeight = SDL_max(shelfHeight, ph);
+	return true;
+}
@@ -1,60 +1,59 @@
 #include "Background.h"
 #include "Util.h"
+#include "Game.h"
 #include <sstream>
+#include <cmath>
 
 using namespace util;
 
 
+//Scroll speed of the outermost layer (px per tick) - the speed the camera
+//scrolls at. The other layers move slower in proportion (parallax)
+static const float ScrollSpeed = 3.0f;
+
+
 Background::Background(int clientWidth, int clientHeight, SDL_Renderer& renderer 
 	, const std::string& fileLayer1, const std::string& fileLayer2, const std::string& fileLayer3)
-	: GameObject("", GT_Background, 1, Direction::Left, 3.0f)
+	: GameObject("", GT_Background, 1, Direction::Left, ScrollSpeed)
 	, scroll(false)
-	, bg1(std::make_unique<BackgroundLayer>(fileLayer1, renderer, clientWidth, clientHeight, 0.25f))
-	, bg2(std::make_unique<BackgroundLayer>(fileLayer2, renderer, clientWidth, clientHeight, 2.0f))
-	, bg3(std::make_unique<BackgroundLayer>(fileLayer3, renderer, clientWidth, clientHeight, 3.0f))
+	, bg1(std::make_unique<BackgroundLayer>(fileLayer1, renderer, clientWidth, clientHeight, 0.25f / ScrollSpeed))
+	, bg2(std::make_unique<BackgroundLayer>(fileLayer2, renderer, clientWidth, clientHeight, 2.0f / ScrollSpeed))
+	, bg3(std::make_unique<BackgroundLayer>(fileLayer3, renderer, clientWidth, clientHeight, 3.0f / ScrollSpeed))
 {
-	//speedX = 3.0f; //speed of the outermost layer
 	position.z = -99999; //bg z-order
+	position.w = (float)clientWidth, position.h = (float)clientHeight; //fills the screen
 	layers.push_back(bg1.get());
 	layers.push_back(bg2.get());
 	layers.push_back(bg3.get());
 }
 
 
+//Layers follow the camera (see BackgroundLayer::Draw) - nothing to do per tick
 void Background::Update()
 {
-	if (!scroll)
-	{
-		return;
-	}
-
-	for(auto& layer : layers)
-	{
-		layer->SetDirection(GetDirection());
-		layer->Update();
-	}
 }
 
 
-void Background::Draw(SDL_Renderer& renderer) const
+void Background::Draw(SpriteBatch& batch) const
 {
 	for(const auto& layer : layers)
 	{
-		layer->Draw(renderer);
+		layer->Draw(batch);
 	}
 }
 
 
 Background::~Background()
 {
-	logPrintf("Background object released");
+	logTrace("Background object released");
 }
 
 
 BackgroundLayer::BackgroundLayer(const std::string& filename, SDL_Renderer& renderer,
-	int _screenWidth, int _screenHeight, float xVel)
+	int _screenWidth, int _screenHeight, float parallax_)
 	: GameObject("", GT_Background, 1, Direction::Left)
 	, texture(nullptr)
+	, parallax(parallax_)
 {
 	SDLSurfaceFromFile fileSurface(filename);
 
@@ -65,70 +64,39 @@ BackgroundLayer::BackgroundLayer(const std::string& filename, SDL_Renderer& rend
 
 	if( !texture )
 	{
-		logPrintf( "Unable to create texture from %s! SDL Error: %s\n", filename.c_str(), SDL_GetError() );
+		logError( "Unable to create texture from %s! SDL Error: %s", filename.c_str(), SDL_GetError() );
 	}
 	else
 	{
-		GameObject::xVel = xVel;
 		screenWidth = _screenWidth, screenHeight = _screenHeight;
-		pos1.w = (float)fileSurface.surface->w, pos1.h = (float)fileSurface.surface->h;
-		pos1.x = 0.0f, pos1.y = 0.0f;
-		
-		pos2.w = (float)fileSurface.surface->w, pos2.h = (float)fileSurface.surface->h;
-		pos2.x = pos2.w, pos2.y = 0.0f;		
+		position.w = (float)fileSurface.surface->w, position.h = (float)fileSurface.surface->h;
 	}
 }
 
 
 BackgroundLayer::~BackgroundLayer()
 {
-	logPrintf("BackgroundLayer released");
+	logTrace("BackgroundLayer released");
 }
 
 
 void BackgroundLayer::Update()
 {
-	if (GetDirection() == Direction::Left) pos1.x -= xVel, pos2.x -= xVel;
-	else if (GetDirection() == Direction::Right) pos1.x += xVel, pos2.x += xVel;
-
-	//std::stringstream ss;
-	//ss << "pos1 {"<< pos1.x << ","<< pos1.y << ","<< pos1.w << "," << pos1.h << "}" << "  " 
-	//	 << "pos2 {"<< pos2.x << ","<< pos2.y << ","<< pos2.w << "," << pos2.h << "}" << "  ";
-	//logPrintf("%s", ss.str().c_str());
-
-	if(GetDirection() == Direction::Left)
-	{
-		if(pos1.x <= -pos1.w)
-		{
-			pos1.x = pos2.x + pos2.w;
-		}
-
-		if(pos2.x <= -pos2.w)
-		{
-			pos2.x = pos1.x + pos1.w;
-		}
-	}
-	else if(GetDirection() == Direction::Right)
-	{
-		if(pos1.x >= pos1.w)
-		{
-			pos1.x = pos2.x - pos2.w;
-		}
-
-		if(pos2.x >= pos2.w)
-		{
-			pos2.x = pos1.x - pos1.w;
-		}
-	}
 }
 
 
-void BackgroundLayer::Draw(SDL_Renderer& renderer) const
+void BackgroundLayer::Draw(SpriteBatch& batch) const
 {
-	SDL_Rect nPos1, nPos2;
-	util::Convert(pos1, nPos1);
-	util::Convert(pos2, nPos2);
-	
-	SDL_RenderCopy( &renderer, texture.get(), nullptr, &nPos1 );
-	SDL_RenderCopy( &renderer, texture.get(), nullptr, &nPos2 );
+	if(position.w <= 0.0f) return;
+
+	//Offset from the camera (interpolated), wrapped to one image width,
+	//then tiled across the screen
+	float x = std::fmod(-GAME.camera.RenderX(GAME.Alpha()) * parallax, position.w);
+	if(x > 0.0f) x -= position.w;
+
+	const SDL_Rect src = { 0, 0, (int)position.w, (int)position.h };
+	for(; x < (float)screenWidth; x += position.w)
+	{
+		batch.Draw( texture.get(), src, RectF(x, 0.0f, position.w, position.h) );
+	}
 }
@@ -0,0 +1,57 @@
+#include "Combat.h"
+#include "GameObject.h"
+
+
+Combat::Combat(size_t initialCapacity)
+	: resolved(0)
+{
+	for(auto& list : events)
+		list.reserve(initialCapacity);
+}
+
+
+void Combat::Resolve(World& world)
+{
+	resolved = 0;
+	for(int type = 0; type < T_Count; ++type)
+	{
+		//By index: resolving can queue more, and only for later types
+		std::vector<Event>& list = events[type];
+		for(size_t i = 0; i < list.size(); ++i)
+		{
+			const Event e = list[i];
+			switch(type)
+			{
+			case T_Hit:
+				logTrace("%s hits %s (%u)", e.source->GetName().c_str(), e.target->GetName().c_str(), (unsigned)e.damage);
+				e.target->OnHit(e.damage);
+				break;
+
+			case T_KnockDown:
+				e.target->KnockedDown();
+				break;
+
+			case T_Death:
+				e.target->OnDied();
+				break;
+
+			case T_Despawn:
+				world.Kill(*e.target);
+				break;
+
+			case T_Sound:
+				MIXER.Play(e.sound);
+				break;
+			}
+		}
+		resolved += list.size();
+		list.clear();
+	}
+}
+
+
+void Combat::Clear()
+{
+	for(auto& list : events)
+		list.clear();
+}
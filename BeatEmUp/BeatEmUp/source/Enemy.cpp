@@ -5,6 +5,7 @@
 
 const float Enemy::Gravity(2.0f);
 const int Enemy::JumpHeight(50);
+const Uint32 Enemy::CorpseTime(3000);
 
 
 Enemy::Enemy(SDL_Renderer& renderer
@@ -31,6 +32,8 @@ Enemy::Enemy(SDL_Renderer& renderer
 	, walkRight(std::move(walkRightSprite))
 	, attackLeft(std::move(attackLeftSprite))
 	, attackRight(std::move(attackRightSprite))
+	, attackRightToken(events::NoToken)
+	, attackLeftToken(events::NoToken)
 	, hitLeft(std::move(hitLeftSprite))
 	, hitRight(std::move(hitRightSprite))
 	, fallLeft(std::move(fallLeftSprite))
@@ -49,6 +52,13 @@ Enemy::Enemy(SDL_Renderer& renderer
 	, AttackTimeOut(attackTimeout)
 	, MinDistX(minDistX)
 	, MinDistY(minDistY)
+	, wakeTick(0)
+	, asleep(false)
+	, rng(__WHEEL.Fork())
+	, committedState(EnemyState::Patrolling)
+	, soundCount(0)
+	, died(false)
+	, expired(false)
 {
 	position.x = posX, position.y = posY, position.w = (float)walkLeft->Position().w;
 	position.h = (float)walkLeft->Position().h;
@@ -59,12 +69,38 @@ Enemy::Enemy(SDL_Renderer& renderer
 Enemy::~Enemy()
 {
 	current = nullptr;
-	logPrintf("Enemy object released");
+	logTrace("Enemy object released");
 }
 
 
+//Serial update (not used by World, which thinks in parallel and commits in order)
 void Enemy::Update()
 {
+	Think();
+	Commit();
+}
+
+
+void Enemy::Think()
+{
+	ALLOC_TAG("Enemy::Think");
+
+	//Too far away to matter - unless in the middle of something (a knock-down
+	//arc frozen in the air, or a corpse that still has to go)
+	const bool settled = Grounded() && (state == EnemyState::Idle || state == EnemyState::Patrolling);
+	if(wakeTick != GAME.clock.Ticks() && settled)
+	{
+		if(!asleep)
+		{
+			//Commit takes us out of the kinematics pass
+			asleep = true;
+			xVel = yVel = 0.0f;
+			current->SetAnimation(false);
+		}
+		return;
+	}
+	asleep = false;
+
 	switch(state)
 	{
 	case EnemyState::KnockedDown:
@@ -73,7 +109,7 @@ void Enemy::Update()
 
 	//Recovery (when hit)
 	case EnemyState::Hit:
-		if(SDL_GetTicks() > recoveryTimer)
+		if(GAME.clock.Now() > recoveryTimer)
 			OnRecovery();
 		break;
 
@@ -96,18 +132,61 @@ void Enemy::Update()
 	case EnemyState::Idle:
 		OnIdle();
 		break;
+
+	//Lie there for a while, then leave the world
+	case EnemyState::Dead:
+		if(GAME.clock.Now() > recoveryTimer)
+			expired = true;
+		break;
 	}
 
-	//Translate/animate
+	//Translate/animate (see OnIntegrated)
 	Translate(xVel != 0 || yVel != 0 || state == EnemyState::Attacking);
+}
+
+
+void Enemy::Commit()
+{
+	for(Uint8 i = 0; i < soundCount; ++i)
+		GAME.world->combat.Sound(*this, sounds[i]);
+	soundCount = 0;
+
+	if(died)
+	{
+		GAME.world->combat.Death(*this);
+		GAME.world->combat.Sound(*this, Mixer::SE_DragonRoar);
+		died = false;
+	}
+
+	if(expired)
+	{
+		GAME.world->combat.Despawn(*this);
+		expired = false;
+	}
+
+	committedState = state;
+	GAME.world->kinematics.SetAwake(*this, !asleep);
+}
+
+
+void Enemy::PlaySound(Mixer::SoundEffect effect)
+{
+	if(soundCount < MaxSounds) sounds[soundCount++] = effect;
+}
+
+
+//Moved by the kinematics pass - follow with the sprite
+void Enemy::OnIntegrated()
+{
+	GAME.enemyGrid.Move(this);
 	Propagate();
 	current->Update();
 }
 
 
-void Enemy::Draw(SDL_Renderer& renderer) const
+void Enemy::Draw(SpriteBatch& batch) const
 {
-	current->Draw(renderer);
+	current->Draw(batch, Interpolate(current->Position()));
 }
 
 
@@ -180,29 +259,6 @@ void Enemy::Stop()
 }
 
 
-void Enemy::Translate()
-{
-	//Handle BG scrolling
-	if(GAME.bg->IsScrolling())
-	{
-		position.x += GAME.bg->GetDirection() == Direction::Left?
-			-GAME.bg->GetSpeedX(): GAME.bg->GetSpeedX();
-	}
-
-	//Translate
-	position.x += xVel;
-	position.y += yVel;
-
-	//Z rules dont apply to jumping
-	if(jumpState == JumpState::Ground)
-	{
-		position.y = position.y < GAME.MoveBounds.top()? GAME.MoveBounds.top(): position.y;
-		AdjustZToGameDepth();
-	}
-	//logPrintf("Enemy Translate: Pos {%d, %d}", (int)position.x, (int)position.y);
-}
-
-
 void Enemy::Propagate()
 {
 	//Propagate to the underlying currently active sprite
@@ -211,14 +267,15 @@ void Enemy::Propagate()
 }
 
 
+//The move itself (velocity, ground/Z rules) is done for all
+//enemies at once by World::kinematics after every object has updated
 void Enemy::Translate(bool anim)
 {
 	current->SetAnimation(anim);
-	Translate();
 }
 
 
-void Enemy::OnHit()
+void Enemy::OnHit(Uint8 damage)
 {
 	if(state != EnemyState::Attacking && state != EnemyState::KnockedDown)
 	{
@@ -226,24 +283,39 @@ void Enemy::OnHit()
 		current = GetDirection() == Direction::Left? hitLeft.get(): hitRight.get();
 		state = EnemyState::Hit;
 		hitCount++;
-		SetHealth(GetHealth() - 1);
+		SetHealth(GetHealth() - damage);
 	
 		if(GetHealth() > 0 && hitCount < KnockDownHitCount){
-			recoveryTimer = SDL_GetTicks() + 400;
+			recoveryTimer = GAME.clock.Now() + 400;
 		}
 		else
 		{
-			hitCount = 0;
-			current = GetDirection() == Direction::Left? fallLeft.get(): fallRight.get();
-			current->SetCurrentFrame(0);
-			state = EnemyState::KnockedDown;
-			recoveryTimer = 0;
-			Jump(8.0f, 10.0f);
+			KnockedDown();
 		}
 	}
 }
 
 
+void Enemy::KnockedDown()
+{
+	hitCount = 0;
+	current = GetDirection() == Direction::Left? fallLeft.get(): fallRight.get();
+	current->SetCurrentFrame(0);
+	state = EnemyState::KnockedDown;
+	recoveryTimer = 0;
+	Jump(8.0f, 10.0f);
+}
+
+
+//Its death, queued by Commit - stop being a target
+void Enemy::OnDied()
+{
+	logPrintf("%s[%u:%u] is dead", GetName().c_str(), handle.index, handle.generation);
+	GAME.enemies.Remove(handle);
+	GAME.enemyGrid.Remove(this);
+}
+
+
 void Enemy::Jump(float xAccel, float yAccel)
 {
 	jumpLocation.x = position.x;
@@ -280,7 +352,7 @@ void Enemy::OnKnockDown()
 			xVel = 0, yVel = 0;
 			position.y = jumpLocation.y;
 			current->SetCurrentFrame(1);
-			MIXER.Play(Mixer::SE_Thud);
+			PlaySound(Mixer::SE_Thud);
 		}
 	}
 	//On-the-ground logic...
@@ -292,17 +364,17 @@ void Enemy::OnKnockDown()
 			if(current->GetCurrentFrame() == 1)
 			{
 				if(recoveryTimer == 0) {
-					recoveryTimer = SDL_GetTicks() + 2000;
-				} else if (SDL_GetTicks() > recoveryTimer) {
+					recoveryTimer = GAME.clock.Now() + 2000;
+				} else if (GAME.clock.Now() > recoveryTimer) {
 					current->SetCurrentFrame(2);
-					recoveryTimer = SDL_GetTicks() + 500;
+					recoveryTimer = GAME.clock.Now() + 500;
 				}
 			}
 			//Half up...
 			else if(current->GetCurrentFrame() == 2)
 			{
 				//full up.. go to idle..
-				if(SDL_GetTicks() > recoveryTimer) {
+				if(GAME.clock.Now() > recoveryTimer) {
 					Stop();
 					state = EnemyState::Idle;
 					//////Quick fix for 'Andore/Axl mis-positioned during getting up when facing right' bug
@@ -322,28 +394,21 @@ void Enemy::OnKnockDown()
 		else
 		{
 			state = EnemyState::Dead;
-			MIXER.Play(Mixer::SE_DragonRoar);
-			auto it = find(GAME.enemies.begin(), GAME.enemies.end(), this);
-			logPrintf("%s[%x] is dead", GetName().c_str(), (unsigned int)*it);
-			GAME.enemies.erase(it);
+			recoveryTimer = GAME.clock.Now() + CorpseTime;
+			died = true;
 		}
 	}
-
-	Translate();
-	current->Position().x = position.x;
-	current->Position().y = position.y;
-	current->Update();
 }
 
 
 void Enemy::VisitAltPlayer()
 {
 	const bool PlayerOnTheLeft = GAME.player->Position().x < position.x;
-	const int MinDistY = __WHEEL.Next(10, 50);
+	const int MinDistY = rng.Next(10, 50);
 	const static int MinDistX = 100;
 //logPrintf("PlayerOnTheLeft? %d", PlayerOnTheLeft);
 	int y = 0;
-	if(__WHEEL.TakeAChance())
+	if(rng.TakeAChance())
 		y = ((int)position.bottom() + MinDistY <= (int)GAME.MoveBounds.bottom()? (int)position.y + MinDistY: (int)GAME.MoveBounds.bottom());
 	else
 		y = ((int)position.top() - MinDistY >= (int)GAME.MoveBounds.top()? (int)position.y - MinDistY: (int)GAME.MoveBounds.top());
@@ -363,7 +428,7 @@ void Enemy::OnPatrol()
 		float distanceToPlayer = util::GetDistance(GAME.player->Position(), position);
 		//logPrintf("vision %f dist %f", vision, distanceToPlayer);
 		if(distanceToPlayer <= vision) {
-			if(__WHEEL.TakeAChance()) /*50-50 chance*/ {
+			if(rng.TakeAChance()) /*50-50 chance*/ {
 				//direct (straight-line path to player)
 				state = EnemyState::Chasing; 
 			}
@@ -401,7 +466,7 @@ void Enemy::OnChase()
 	//teleport
 	//if(distX <= 3 * MinDistX)
 	//{
-	//	Enemy* neighbour = GetNearestNeighbour< Enemy >(GAME.enemies);
+	//	Enemy* neighbour = GAME.enemyGrid.NearestInXRange(*this);
 	//	if(neighbour && neighbour->IsAttackable()) 
 	//	{
 	//		if(__WHEEL.TakeAChance())
@@ -454,7 +519,7 @@ void Enemy::OnRecovery()
 
 void Enemy::OnAttack()
 {
-	if(SDL_GetTicks() - attackTimer > AttackTimeOut)
+	if(GAME.clock.Now() - attackTimer > AttackTimeOut)
 	{
 		state = EnemyState::Idle;
 		attackTimer = 0;
@@ -465,7 +530,7 @@ void Enemy::OnAttack()
 void Enemy::Attack()
 {
 	state = EnemyState::Attacking;
-	attackTimer = SDL_GetTicks();
+	attackTimer = GAME.clock.Now();
 	current = GetDirection() == Direction::Left? attackLeft.get(): attackRight.get();
 	current->Rewind();
 }
@@ -476,16 +541,16 @@ void Enemy::OnIdle()
 	if(!idleTimer)
 	{
 		Stop();
-		//idleTimer = SDL_GetTicks() + __WHEEL.Next(1000, 3000);
-		idleTimer = SDL_GetTicks() + __WHEEL.Next(100, 1000);
+		//idleTimer = GAME.clock.Now() + __WHEEL.Next(1000, 3000);
+		idleTimer = GAME.clock.Now() + rng.Next(100, 1000);
 	}
 	else
 	{
-		if(SDL_GetTicks() >= idleTimer)
+		if(GAME.clock.Now() >= idleTimer)
 		{
 			state = EnemyState::Chasing;
-			Enemy* neighbour = GameObject::GetNearestNeighbour(GAME.enemies); 
-			if(neighbour && neighbour->state == EnemyState::Chasing)
+			Enemy* neighbour = GAME.enemyGrid.NearestInXRange(*this);
+			if(neighbour && neighbour->committedState == EnemyState::Chasing)
 			{
 				VisitAltPlayer();
 			}
@@ -516,8 +581,8 @@ Andore::Andore(SDL_Renderer& renderer_, float posX, float posY)
 		Sprite::FromFile("resources/andore_fallright.png", renderer_, 150, 120, 1, 0), 
 		"Andore", posX, posY, 30, 300, 1.5f, 200.0f, 0.0f, 350.0f, 40.0f, 0.0f)
 {
-	attackLeft->FramePlayed.attach(*this, &Andore::OnPunchSprite);
-	attackRight->FramePlayed.attach(*this, &Andore::OnPunchSprite);
+	attackLeftToken = attackLeft->FramePlayed.attach(*this, &Andore::OnPunchSprite);
+	attackRightToken = attackRight->FramePlayed.attach(*this, &Andore::OnPunchSprite);
 }
 
 
@@ -525,14 +590,15 @@ void Andore::OnPunchSprite(const Sprite& sender, const Sprite::FramePlayedEventA
 {
 	if(e.FrameIndex == 1)
 	{
+		Combat& combat = GAME.world->combat;
 		if(!GAME.player->IsDown() && CollidedWith(*GAME.player, 0, 0))
 		{
-			MIXER.Play(Mixer::SE_PunchHit);
-			GAME.player->OnHit();
+			combat.Hit(*this, *GAME.player);
+			combat.Sound(*this, Mixer::SE_PunchHit);
 		}
 		else
 		{
-			MIXER.Play(Mixer::SE_Punch);
+			combat.Sound(*this, Mixer::SE_Punch);
 		}
 	}
 }
@@ -540,9 +606,9 @@ void Andore::OnPunchSprite(const Sprite& sender, const Sprite::FramePlayedEventA
 
 Andore::~Andore()
 {
-	attackLeft->FramePlayed.detach(*this, &Andore::OnPunchSprite);
-	attackRight->FramePlayed.detach(*this, &Andore::OnPunchSprite);
-	logPrintf("Andore released");
+	attackLeft->FramePlayed.detach(attackLeftToken);
+	attackRight->FramePlayed.detach(attackRightToken);
+	logTrace("Andore released");
 }
 
 
@@ -561,8 +627,8 @@ Axl::Axl(SDL_Renderer& renderer_, float posX, float posY)
 		Sprite::FromFile("resources/axl_fallright.png", renderer_, 150, 120, 1, 0), 
 		"Axl", posX, posY, 20, 300, 2.0f, 400.0f, 0.0f, 250.0f, 30.0f, 0.0f)
 {
-	attackLeft->FramePlayed.attach(*this, &Axl::OnPunchSprite);
-	attackRight->FramePlayed.attach(*this, &Axl::OnPunchSprite);
+	attackLeftToken = attackLeft->FramePlayed.attach(*this, &Axl::OnPunchSprite);
+	attackRightToken = attackRight->FramePlayed.attach(*this, &Axl::OnPunchSprite);
 }
 
 
@@ -570,14 +636,15 @@ void Axl::OnPunchSprite(const Sprite& sender, const Sprite::FramePlayedEventArgs
 {
 	if(e.FrameIndex == 1)
 	{
+		Combat& combat = GAME.world->combat;
 		if(!GAME.player->IsDown() && CollidedWith(*GAME.player, 0, 0))
 		{
-			MIXER.Play(Mixer::SE_Kick);
-			GAME.player->OnHit();
+			combat.Hit(*this, *GAME.player);
+			combat.Sound(*this, Mixer::SE_Kick);
 		}
 		else
 		{
-			MIXER.Play(Mixer::SE_Punch);
+			combat.Sound(*this, Mixer::SE_Punch);
 		}
 	}
 }
@@ -585,9 +652,9 @@ void Axl::OnPunchSprite(const Sprite& sender, const Sprite::FramePlayedEventArgs
 
 Axl::~Axl()
 {
-	attackLeft->FramePlayed.detach(*this, &Axl::OnPunchSprite);
-	attackRight->FramePlayed.detach(*this, &Axl::OnPunchSprite);
-	logPrintf("Axl released");
+	attackLeft->FramePlayed.detach(attackLeftToken);
+	attackRight->FramePlayed.detach(attackRightToken);
+	logTrace("Axl released");
 }
 
 
@@ -606,16 +673,16 @@ Joker::Joker(SDL_Renderer& renderer_, float posX, float posY)
 		Sprite::FromFile("resources/joker_fallright.png", renderer_, 90, 90, 1, 0), 
 		"Joker", posX, posY, 10, 550, 1.0f, 200.0f, 0.0f, 250.0f, 90.0f, 0.0f)
 {
-	attackLeft->FramePlayed.attach(*this, &Joker::OnStickSprite);
-	attackRight->FramePlayed.attach(*this, &Joker::OnStickSprite);
+	attackLeftToken = attackLeft->FramePlayed.attach(*this, &Joker::OnStickSprite);
+	attackRightToken = attackRight->FramePlayed.attach(*this, &Joker::OnStickSprite);
 }
 
 
 Joker::~Joker()
 {
-	attackLeft->FramePlayed.detach(*this, &Joker::OnStickSprite);
-	attackRight->FramePlayed.detach(*this, &Joker::OnStickSprite);
-	logPrintf("Joker released");
+	attackLeft->FramePlayed.detach(attackLeftToken);
+	attackRight->FramePlayed.detach(attackRightToken);
+	logTrace("Joker released");
 }
 
 
@@ -623,19 +690,20 @@ void Joker::OnStickSprite(const Sprite& sender, const Sprite::FramePlayedEventAr
 {
 	if(e.FrameIndex == 2)
 	{
+		Combat& combat = GAME.world->combat;
 		if(!GAME.player->IsDown()) 
 		{
 			bool collision = CollidedWith(*GAME.player, -60, 0, 15);
 			if(collision) {
-				MIXER.Play(Mixer::SE_PunchHit);
-				GAME.player->OnHit();
+				combat.Hit(*this, *GAME.player);
+				combat.Sound(*this, Mixer::SE_PunchHit);
 			}
 			else {
-				MIXER.Play(Mixer::SE_Punch);
+				combat.Sound(*this, Mixer::SE_Punch);
 			}
 		}
 		else {
-			MIXER.Play(Mixer::SE_Punch);
+			combat.Sound(*this, Mixer::SE_Punch);
 		}
 	}
 }
@@ -668,16 +736,13 @@ Rock::Rock(const string& file, SDL_Renderer& renderer)
  : GameObject("Rock", GT_Enemy, 1, Direction::Left, 10.0f) 
  , texture(nullptr)
 {
-	util::SDLSurfaceFromFile surf(file, true);
-
-	texture = unique_ptr2<SDL_Texture>(
-		SDL_CreateTextureFromSurface(&renderer, surf.surface)
-		, [](auto p) { SDL_DestroyTexture(p); }
-	);
+	const TextureRef ref = ASSETS.Texture(file, renderer, true);
+	texture = ref.texture;
+	region = ref.rect;
 
 	position.x = Range;
-	position.w = (float)surf.surface->w;
-	position.h = (float)surf.surface->h;
+	position.w = (float)region.w;
+	position.h = (float)region.h;
 	position.y = (float)GAME.RandomYWithinMoveBounds((int)position.h);
 	AdjustZToGameDepth();
 }
@@ -714,25 +779,23 @@ void Rock::Update()
 	//collision detection
 	if(!GAME.player->IsDown() && CollidedWith(*GAME.player))
 	{
-		GAME.player->Stop();
-		GAME.player->OnHit();
-		GAME.player->KnockedDown();
-		MIXER.Play(Mixer::SE_Grunt);
+		Combat& combat = GAME.world->combat;
+		combat.Hit(*this, *GAME.player);
+		combat.KnockDown(*this, *GAME.player);
+		combat.Sound(*this, Mixer::SE_Grunt);
 	}
 }
 
 
-void Rock::Draw(SDL_Renderer& renderer) const
+void Rock::Draw(SpriteBatch& batch) const
 {
-	SDL_Rect nPos;
-	util::Convert(position, nPos);
-	SDL_RenderCopyEx(&renderer, texture.get(), nullptr, &nPos, GetAngle(), nullptr, SDL_FLIP_NONE);
+	batch.Draw(texture.get(), region, Interpolate(position), GetAngle());
 }
 
 
 Rock::~Rock()
 {
-	logPrintf("Rock object released");
+	logTrace("Rock object released");
 }
 
 #pragma endregion
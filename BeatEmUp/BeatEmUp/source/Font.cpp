@@ -0,0 +1,104 @@
+#include "Font.h"
+#include "Atlas.h"
+#include <SDL_ttf.h>
+
+
+using namespace std;
+using namespace util;
+
+
+//Plenty for 95 glyphs at HUD sizes; trimmed to what is used
+const int GlyphPageWidth = 512;
+const int GlyphPageHeight = 512;
+
+
+GlyphAtlas::GlyphAtlas(const string& fileName, int size, SDL_Renderer& renderer)
+	: texture(nullptr)
+	, lineHeight(0)
+{
+	SDL_memset(glyphs, 0, sizeof(glyphs));
+
+	//The font is only needed while rasterising
+	TTFont font(fileName, size);
+	if(!font.font) return;
+	lineHeight = TTF_FontHeight(font.font);
+
+	//Each glyph is rendered as a one character line so it comes out the
+	//full line height with the baseline where TTF_RenderText puts it
+	const SDL_Colour white = { 0xFF, 0xFF, 0xFF, 0xFF };
+	vector<unique_ptr2<SDL_Surface>> surfaces;
+	surfaces.reserve(GlyphCount);
+	AtlasPacker packer(GlyphPageWidth, GlyphPageHeight);
+	for(int i = 0; i < GlyphCount; ++i)
+	{
+		const char text[2] = { (char)(FirstGlyph + i), '\0' };
+		int minX = 0, maxX = 0, minY = 0, maxY = 0, advance = 0;
+		if(TTF_GlyphMetrics(font.font, (Uint16)text[0], &minX, &maxX, &minY, &maxY, &advance) == 0)
+		{
+			glyphs[i].advance = advance;
+		}
+
+		surfaces.push_back(unique_ptr2<SDL_Surface>(TTF_RenderText_Blended(font.font, text, white)
+			, [](SDL_Surface* s) { if(s) SDL_FreeSurface(s); }));
+		const SDL_Surface* surface = surfaces.back().get();
+		if(!surface || surface->w <= 0) continue;
+		if(glyphs[i].advance == 0) glyphs[i].advance = surface->w;
+
+		if(!packer.Insert(surface->w, surface->h, glyphs[i].rect))
+		{
+			logWarn("Glyph atlas for %s (%d) is full at '%s'", fileName.c_str(), size, text);
+			glyphs[i].rect.w = glyphs[i].rect.h = 0;
+		}
+	}
+
+	unique_ptr2<SDL_Surface> canvas(CreateRGBASurface(GlyphPageWidth, packer.UsedHeight())
+		, [](SDL_Surface* s) { if(s) SDL_FreeSurface(s); });
+	if(!canvas) return;
+
+	for(int i = 0; i < GlyphCount; ++i)
+	{
+		if(!surfaces[i] || glyphs[i].rect.w == 0) continue;
+		//Copy coverage straight into the alpha channel
+		SDL_SetSurfaceBlendMode(surfaces[i].get(), SDL_BLENDMODE_NONE);
+		SDL_Rect dest = glyphs[i].rect;
+		SDL_BlitSurface(surfaces[i].get(), nullptr, canvas.get(), &dest);
+	}
+
+	texture = shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(&renderer, canvas.get())
+		, [](SDL_Texture* p) { if(p) SDL_DestroyTexture(p); });
+	if(!texture.get())
+	{
+		logError("Unable to create glyph atlas for %s! SDL Error: %s", fileName.c_str(), SDL_GetError());
+		texture.reset();
+		return;
+	}
+	SDL_SetTextureBlendMode(texture.get(), SDL_BLENDMODE_BLEND);
+	logPrintf("Glyph atlas %s (%d): %dx%d", fileName.c_str(), size, GlyphPageWidth, packer.UsedHeight());
+}
+
+
+int GlyphAtlas::Measure(const string& text) const
+{
+	int width = 0;
+	for(const char c : text)
+		width += Find(c).advance;
+	return width;
+}
+
+
+void GlyphAtlas::Draw(SpriteBatch& batch, const string& text, float x, float y, const SDL_Colour& colour) const
+{
+	if(!texture) return;
+
+	RectF dest(x, y);
+	for(const char c : text)
+	{
+		const Glyph& glyph = Find(c);
+		if(glyph.rect.w > 0)
+		{
+			dest.w = (float)glyph.rect.w, dest.h = (float)glyph.rect.h;
+			batch.Draw(texture.get(), glyph.rect, dest, 0.0, colour);
+		}
+		dest.x += glyph.advance;
+	}
+}
@@ -1,7 +1,62 @@
 #include "Game.h"
-#include <sstream>
+#include "Allocations.h"
 #include <algorithm>
 #include "Mixer.h"
+#include "Profiler.h"
+
+
+//Sprite sheets packed into the texture atlas at startup
+//File and colour key must match what the sprites load (see Sprite::FromFile)
+static const AtlasImage SpriteSheets[] =
+{
+	{ "resources/baddude_stanceleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_stanceright.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_walkleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_walkright.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_kickleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_kickright.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_hitleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_hitright.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_fallleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_fallright.png", 0x00, 0x00, 0x00 },
+	{ "resources/baddude_punchleft.png", 0xFF, 0xFF, 0xFF },
+	{ "resources/baddude_punchright.png", 0xFF, 0xFF, 0xFF },
+	{ "resources/andore_idleleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_idleright.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_walkleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_walkright.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_punchleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_punchright.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_hitleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_hitright.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_fallleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/andore_fallright.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_idleleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_idleright.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_walkleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_walkright.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_kickleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_kickright.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_hitleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_hitright.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_fallleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/axl_fallright.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_idleleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_idleright.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_walkleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_walkright.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_attackleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_attackright.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_hitleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_hitright.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_fallleft.png", 0x00, 0x00, 0x00 },
+	{ "resources/joker_fallright.png", 0x00, 0x00, 0x00 },
+	{ "resources/skater_left.png", 0x00, 0x00, 0x00 },
+	{ "resources/skater_right.png", 0x00, 0x00, 0x00 },
+	{ "resources/knightwalk_left.png", 0x00, 0x00, 0x00 },
+	{ "resources/knightwalk_right.png", 0x00, 0x00, 0x00 },
+	{ "resources/rock.png", 0x00, 0x00, 0x00 },
+};
 
 
 Game::Game() 
@@ -9,6 +64,10 @@ Game::Game()
 	, SCREEN_HEIGHT
 	, "Nasir's Beat 'em Up Game")
 	, MoveBounds(0.0f, 370.0f, (float)SCREEN_WIDTH, 120.0f)
+	, clock(SIM_HZ)
+	, camera((float)SCREEN_WIDTH, (float)SCREEN_HEIGHT)
+	, wakeRadius((float)SCREEN_WIDTH)
+	, awakeEnemies(0)
 	, player(nullptr)
 	, tbFps(nullptr), tbPlayerPos(nullptr), tbEnemyPos(nullptr)
 	, bg(nullptr)
@@ -17,15 +76,29 @@ Game::Game()
 	, rightDown(false)
 	, upDown(false)
 	, downDown(false)
+	, showProfiler(false)
 	, currentLevel(0LU)
 	, MaxLevel(10LU)
+	, stress()
+	, zeroAllocAfter(0)
+	, zeroAllocFailures(0)
+	, recordInput(false)
+	, levelArena(0)
 {
+	SDL_zero(hud);
+	hud.fps = -1.0f; //first Update builds the text
 }
 
 
 Game::~Game()
 {
-	logPrintf("Game object released");
+	//Level objects live in levelArenas - destroy them first
+	//Atlas pages are not ours to release: the AssetRegistry is first used in
+	//Init, after Game is built, so it is destroyed (and frees them) before Game
+	//and its renderer. Whatever still shares a page here lets go of it below,
+	//still ahead of ~SDLApp
+	world.reset();
+	logTrace("Game object released");
 }
 
 
@@ -33,6 +106,12 @@ bool Game::Init()
 {
 	if(!SDLApp::Init())
 		return false;
+	logPrintf("Random seed: %llu", (unsigned long long)__WHEEL.GetSeed());
+	if(recordInput) recording.Start(__WHEEL.GetSeed());
+
+	//Pack the sprite sheets into shared textures (fewer texture switches when drawing)
+	ASSETS.BuildAtlas(renderer(), SpriteSheets, SDL_arraysize(SpriteSheets));
+	batch = make_unique<SpriteBatch>(renderer());
 
 	//Create and add player
 	//currently only one character (baddude) supported
@@ -41,6 +120,14 @@ bool Game::Init()
 	tbPlayerPos = make_unique<TextBlock>("Pos {}", 16, 0.0f, tbFps->Position().bottom() + 1, renderer());
 	tbEnemyPos = make_unique<TextBlock>("Enemy Pos {}", 16, 0.0f, tbPlayerPos->Position().bottom() + 1, renderer());
 
+	//Profiler overlay - drawn on top of the world, not part of it
+	float y = tbEnemyPos->Position().bottom() + 1;
+	for(int phase = 0; phase < Profiler::PH_Count; ++phase)
+	{
+		tbProfile.push_back(make_unique<TextBlock>(Profiler::PhaseName((Profiler::Phase)phase), 16, 0.0f, y, renderer()));
+		y = tbProfile.back()->Position().bottom() + 1;
+	}
+
 	//Load level1
 	LoadNextLevel();
 
@@ -56,9 +143,17 @@ void Game::ProcessEvent(const SDL_Event& e)
 	//For now we just disable player keys
 	//TODO Add proper keyboard control (e.g. properly handling ESC/F1/other keys
 	//when player is dead)
-	if(player->IsDead())
+	if(player->IsDead()) return;
+	//e.key is only meaningful for key events (mouse, window... events share the union)
+	if(e.type != SDL_KEYDOWN && e.type != SDL_KEYUP) return;
+
+	//Player keys become actions (recorded, unless a replay is playing them instead)
+	InputRecording::Action action;
+	if(!e.key.repeat && KeyAction(e.key.keysym.sym, e.key.state == SDL_PRESSED, action))
 	{
-		leftDown = rightDown = upDown = downDown = false;
+		if(recording.IsPlaying()) return;
+		recording.Record(clock.Ticks(), action);
+		Act(action);
 		return;
 	}
 
@@ -69,76 +164,190 @@ void Game::ProcessEvent(const SDL_Event& e)
 		case SDLK_F1:
 			ToggleFullScreen();
 			break;
-		case SDLK_ESCAPE:
-			quit_ = true;
-			break;
-			/* Player Keys */
-		case SDLK_LEFT:
-			leftDown = true;
-			bg->SetScroll(Direction::Right);
+		case SDLK_F2:
+			showProfiler = !showProfiler;
 			break;
-		case SDLK_RIGHT:
-			rightDown = true;
-			bg->SetScroll(Direction::Left);
+		case SDLK_F9:
+			PROFILER.ExportCSV("profile.csv");
 			break;
-		case SDLK_UP:
-			upDown = true;
-			bg->SetScroll(player->GetDirection() == Direction::Right? Direction::Left : Direction::Right);
+		case SDLK_F10:
+			PROFILER.ExportTrace("profile.json");
 			break;
-		case SDLK_DOWN:
-			downDown = true;
-			bg->SetScroll(player->GetDirection() == Direction::Right? Direction::Left : Direction::Right);
+		case SDLK_ESCAPE:
+			quit_ = true;
 			break;
-		case SDLK_SPACE:
-			player->Jump();
+			/* Game clock */
+		case SDLK_p:
+			clock.TogglePause();
 			break;
-		case SDLK_a:
-			player->Punch();
+		case SDLK_EQUALS:
+			clock.SetTimeScale(clock.TimeScale() * 2.0f);
 			break;
-		case SDLK_s:
-			player->Kick();
+		case SDLK_MINUS:
+			clock.SetTimeScale(clock.TimeScale() / 2.0f);
 			break;
 		}
 	}
-	else if(e.key.state == SDL_RELEASED && !e.key.repeat)
+}
+
+
+//Player keys
+bool Game::KeyAction(SDL_Keycode key, bool pressed, InputRecording::Action& action)
+{
+	switch(key)
 	{
-		switch(e.key.keysym.sym)
-		{
-		case SDLK_LEFT:
-			leftDown = false;
-			Stop();
-			break;
-		case SDLK_RIGHT:
-			rightDown = false;
-			Stop();
-			break;
-		case SDLK_UP:
-			upDown = false;
-			Stop();
-			break;
-		case SDLK_DOWN:
-			downDown = false;
-			Stop();
-			break;
-		}
+	case SDLK_LEFT:		action = pressed? InputRecording::A_LeftPress: InputRecording::A_LeftRelease; return true;
+	case SDLK_RIGHT:	action = pressed? InputRecording::A_RightPress: InputRecording::A_RightRelease; return true;
+	case SDLK_UP:		action = pressed? InputRecording::A_UpPress: InputRecording::A_UpRelease; return true;
+	case SDLK_DOWN:		action = pressed? InputRecording::A_DownPress: InputRecording::A_DownRelease; return true;
+	case SDLK_SPACE:	action = InputRecording::A_Jump; return pressed;
+	case SDLK_a:		action = InputRecording::A_Punch; return pressed;
+	case SDLK_s:		action = InputRecording::A_Kick; return pressed;
+	}
+	return false;
+}
+
+
+//What a player key does - from the keyboard, or from a replay on the tick it was recorded
+void Game::Act(InputRecording::Action action)
+{
+	switch(action)
+	{
+	case InputRecording::A_LeftPress:
+		leftDown = true;
+		bg->SetScroll(Direction::Right);
+		break;
+	case InputRecording::A_RightPress:
+		rightDown = true;
+		bg->SetScroll(Direction::Left);
+		break;
+	case InputRecording::A_UpPress:
+		upDown = true;
+		bg->SetScroll(player->GetDirection() == Direction::Right? Direction::Left : Direction::Right);
+		break;
+	case InputRecording::A_DownPress:
+		downDown = true;
+		bg->SetScroll(player->GetDirection() == Direction::Right? Direction::Left : Direction::Right);
+		break;
+	case InputRecording::A_LeftRelease:
+		leftDown = false;
+		Stop();
+		break;
+	case InputRecording::A_RightRelease:
+		rightDown = false;
+		Stop();
+		break;
+	case InputRecording::A_UpRelease:
+		upDown = false;
+		Stop();
+		break;
+	case InputRecording::A_DownRelease:
+		downDown = false;
+		Stop();
+		break;
+	case InputRecording::A_Jump:
+		player->Jump();
+		break;
+	case InputRecording::A_Punch:
+		player->Punch();
+		break;
+	case InputRecording::A_Kick:
+		player->Kick();
+		break;
 	}
 }
 
 
+bool Game::SetReplay(const string& fileName)
+{
+	if(!recording.Load(fileName)) return false;
+	__WHEEL.Seed(recording.Seed());
+	return true;
+}
+
+
+bool Game::SaveRecording(const string& fileName)
+{
+	recording.Finish(clock.Ticks(), StateChecksum());
+	return recording.Save(fileName);
+}
+
+
+bool Game::CheckReplay() const
+{
+	const Uint32 checksum = StateChecksum();
+	const bool complete = clock.Ticks() == recording.EndTick();
+	const bool matched = complete && checksum == recording.Checksum();
+	printf("Replay: %llu/%llu ticks, state %08x (recorded %08x) - %s\n"
+		, (unsigned long long)clock.Ticks(), (unsigned long long)recording.EndTick(), checksum, recording.Checksum()
+		, matched? "identical": complete? "DIVERGED": "incomplete");
+	return matched;
+}
+
+
+//Hash of the game state a replay must reproduce
+Uint32 Game::StateChecksum() const
+{
+	Checksum sum;
+	sum.Add(clock.Ticks());
+	sum.Add((Uint64)currentLevel);
+	sum.Add(camera.X());
+	sum.Add(player->Position());
+	sum.Add(player->GetHealth());
+	sum.Add(player->GetState());
+	sum.Add((Uint64)enemies.Count());
+	enemies.ForEach([&](const Enemy* enemy)
+	{
+		sum.Add(enemy->Position());
+		sum.Add(enemy->GetHealth());
+	});
+	return sum.Value();
+}
+
+
 bool Game::LevelComplete() const
 {
 	//all enemies destroyed!
-	return enemies.size() <= 0;
+	return enemies.Count() <= 0;
+}
+
+
+//AI level of detail: wakes the enemies near enough to the view for this tick
+//Only those are found (spatial query) and only those run their AI, so enemies
+//far away cost next to nothing however many there are
+void Game::WakeEnemies()
+{
+	const RectF view = camera.View();
+	const Uint64 tick = clock.Ticks();
+	awakeEnemies = 0;
+	enemyGrid.ForEachInXRange(view.left() - wakeRadius, view.right() + wakeRadius, [&](Enemy* enemy)
+	{
+		enemy->Wake(tick);
+		++awakeEnemies;
+	});
+}
+
+
+void Game::AddEnemy(Enemy* enemy)
+{
+	if(!enemy) return;
+	enemy->SetHandle(enemies.Add(enemy));
+	enemyGrid.Insert(enemy);
+	world->kinematics.Add(*enemy);
 }
 
 
 bool Game::LoadNextLevel()
 {
+	//Loading is allowed to allocate (zero-alloc check)
+	ALLOC_TAG("LoadNextLevel");
+	AllowAllocations loading;
+
 	if(currentLevel < MaxLevel) 
 		currentLevel++;
 	else 
 		return false;
-	logPrintf("Loading Level{%lu}", currentLevel);
+	logPrintf("Loading Level{%lu}", (unsigned long)currentLevel);
 
 	switch(currentLevel)
 	{
@@ -154,42 +363,61 @@ bool Game::LoadNextLevel()
 	case 9:
 	case 10:
 		{
-			enemies.clear();
-			world.reset(new World);
+			enemies.Clear();
+			enemyGrid.Clear();
+			//New level starts at the origin; the player keeps its place on screen
+			player->Position().x -= camera.X();
+			camera.Reset();
+			//Keep the old level alive until the new one is built so the
+			//textures both levels use stay loaded (AssetRegistry holds weak refs)
+			unique_ptr<World> previous(std::move(world));
+			levelArena = (levelArena + 1) % SDL_arraysize(levelArenas);
+			levelArenas[levelArena].Reset();
+			world.reset(new World(&levelArenas[levelArena]));
 
 			//Add background
 			bg = world->AddGameObject<Background>(clientWidth_, clientHeight_, renderer(), "resources/bg1.gif", "resources/bg2.gif", "resources/bg3.gif");
 
-			//Add some 'roamers'
-			world->AddGameObject<Roamer>(renderer(), 
-				Sprite::FromFile("resources/skater_left.png", renderer(), 71, 90, 11, 0),
-				Sprite::FromFile("resources/skater_right.png", renderer(), 71, 90, 11, 0), 
-				-200.0f, 390.0f, -200.0f, 1000.0f, true);
-
-			world->AddGameObject<Roamer>(renderer(), 
-				Sprite::FromFile("resources/knightwalk_left.png", renderer(), 128, 128, 4, 15),
-				Sprite::FromFile("resources/knightwalk_right.png", renderer(), 128, 128, 4, 3), 
-				5000.0f, 480.0f, -5000.0f, 5000.0f, false);
-
-			//Add a rock
-			world->AddGameObject<Rock>("resources/rock.png", renderer());
-
-			//Add some enemies
-			enemies.push_back(world->AddGameObject<Andore>(renderer(), 1200.0f, 450.0f));
-			//enemies.push_back(world->AddGameObject<Andore>(renderer(), 1200.0f, 450.0f));
-			enemies.push_back(world->AddGameObject<Andore>(renderer(), 2400.0f, 450.0f));
-			//enemies.push_back(world->AddGameObject<Joker>(renderer(), 1000.0f, 400.0f));
-			enemies.push_back(world->AddGameObject<Axl>(renderer(), 800.0f, 400.0f));
-			enemies.push_back(world->AddGameObject<Andore>(renderer(), 700.0f, 380.0f));
-			enemies.push_back(world->AddGameObject<Axl>(renderer(), -200.0f, 400.0f));
-			//enemies.push_back(world->AddGameObject<Joker>(renderer(), 1100.0f, 400.0f));
-			enemies.push_back(world->AddGameObject<Axl>(renderer(), 500.0f, 400.0f));
+			if(stress.Any())
+			{
+				SpawnStress();
+			}
+			else
+			{
+				//Add some 'roamers'
+				world->AddGameObject<Roamer>(renderer(), 
+					Sprite::FromFile("resources/skater_left.png", renderer(), 71, 90, 11, 0),
+					Sprite::FromFile("resources/skater_right.png", renderer(), 71, 90, 11, 0), 
+					-200.0f, 390.0f, -200.0f, 1000.0f, true);
+
+				world->AddGameObject<Roamer>(renderer(), 
+					Sprite::FromFile("resources/knightwalk_left.png", renderer(), 128, 128, 4, 15),
+					Sprite::FromFile("resources/knightwalk_right.png", renderer(), 128, 128, 4, 3), 
+					5000.0f, 480.0f, -5000.0f, 5000.0f, false);
+
+				//Add a rock
+				world->AddGameObject<Rock>("resources/rock.png", renderer());
+
+				//Add some enemies
+				AddEnemy(world->AddGameObject<Andore>(renderer(), 1200.0f, 450.0f));
+				//AddEnemy(world->AddGameObject<Andore>(renderer(), 1200.0f, 450.0f));
+				AddEnemy(world->AddGameObject<Andore>(renderer(), 2400.0f, 450.0f));
+				//AddEnemy(world->AddGameObject<Joker>(renderer(), 1000.0f, 400.0f));
+				AddEnemy(world->AddGameObject<Axl>(renderer(), 800.0f, 400.0f));
+				AddEnemy(world->AddGameObject<Andore>(renderer(), 700.0f, 380.0f));
+				AddEnemy(world->AddGameObject<Axl>(renderer(), -200.0f, 400.0f));
+				//AddEnemy(world->AddGameObject<Joker>(renderer(), 1100.0f, 400.0f));
+				AddEnemy(world->AddGameObject<Axl>(renderer(), 500.0f, 400.0f));
+			}
 
 			//Add non-owned objects so then can be drawn
 			world->AddGameObject(*tbFps);
 			world->AddGameObject(*tbPlayerPos);
 			world->AddGameObject(*tbEnemyPos);
 			world->AddGameObject(*player);
+			previous.reset();
+			logPrintf("Level arena: %lu of %lu bytes used", (unsigned long)levelArenas[levelArena].Used()
+				, (unsigned long)levelArenas[levelArena].Capacity());
 		}
 		break;
 
@@ -199,29 +427,263 @@ bool Game::LoadNextLevel()
 	//break;
 
 	default:
-		logPrintf("*** MUST NEVER GET HERE ***");
+		logError("*** MUST NEVER GET HERE ***");
 		return false;
 	}
 
-	logPrintf("Level{%lu} Loaded.  gameObjects<%d>", currentLevel, world->Count());
+	logPrintf("Level{%lu} Loaded.  gameObjects<%d>  textures: %lu live, %lu loads, %lu shared"
+		, (unsigned long)currentLevel, (int)world->Count(), (unsigned long)ASSETS.Live(), (unsigned long)ASSETS.Loads(), (unsigned long)ASSETS.Hits());
 	return true;
 }
 
 
+Game::StressConfig Game::StressConfig::Scaled(size_t count)
+{
+	StressConfig config;
+	config.andores = count - count / 3 * 2;
+	config.axls = count / 3;
+	config.jokers = count / 3;
+	config.roamers = count / 10;
+	config.rocks = count / 100;
+	return config;
+}
+
+
+//Same layout every time for the same seed and counts, so runs compare
+void Game::SpawnStress()
+{
+	util::Random rng(__WHEEL.Fork());
+	const float halfSpan = SDL_max(2000.0f, 10.0f * (float)stress.Enemies());
+	auto randomX = [&]() { return rng.Next(-halfSpan, halfSpan); };
+	auto randomY = [&]() { return rng.Next(380.0f, 450.0f); };
+
+	for(size_t i = 0; i < stress.roamers; ++i)
+	{
+		const float x = randomX();
+		if(i % 2 == 0)
+			world->AddGameObject<Roamer>(renderer(), 
+				Sprite::FromFile("resources/skater_left.png", renderer(), 71, 90, 11, 0),
+				Sprite::FromFile("resources/skater_right.png", renderer(), 71, 90, 11, 0), 
+				x, 390.0f, x - 1000.0f, x + 1000.0f, true);
+		else
+			world->AddGameObject<Roamer>(renderer(), 
+				Sprite::FromFile("resources/knightwalk_left.png", renderer(), 128, 128, 4, 15),
+				Sprite::FromFile("resources/knightwalk_right.png", renderer(), 128, 128, 4, 3), 
+				x, 480.0f, x - 1000.0f, x + 1000.0f, false);
+	}
+
+	for(size_t i = 0; i < stress.rocks; ++i)
+	{
+		Rock* rock = world->AddGameObject<Rock>("resources/rock.png", renderer());
+		if(rock) rock->Position().x = randomX();
+	}
+
+	for(size_t i = 0; i < stress.andores; ++i)
+		AddEnemy(world->AddGameObject<Andore>(renderer(), randomX(), randomY()));
+	for(size_t i = 0; i < stress.axls; ++i)
+		AddEnemy(world->AddGameObject<Axl>(renderer(), randomX(), randomY()));
+	for(size_t i = 0; i < stress.jokers; ++i)
+		AddEnemy(world->AddGameObject<Joker>(renderer(), randomX(), randomY()));
+}
+
+
+//Benchmark player: walks right and back, fights, jumps - on a loop
+//Goes through ProcessEvent like real key presses
+void Game::ScriptInput(Uint64 tick)
+{
+	struct Step
+	{
+		Uint32 tick;
+		Uint8 state;
+		SDL_Keycode key;
+	};
+	static const Step Script[] =
+	{
+		{ 0, SDL_PRESSED, SDLK_RIGHT },
+		{ 60, SDL_RELEASED, SDLK_RIGHT },
+		{ 60, SDL_PRESSED, SDLK_a },
+		{ 75, SDL_PRESSED, SDLK_s },
+		{ 90, SDL_PRESSED, SDLK_LEFT },
+		{ 150, SDL_RELEASED, SDLK_LEFT },
+		{ 150, SDL_PRESSED, SDLK_UP },
+		{ 170, SDL_RELEASED, SDLK_UP },
+		{ 170, SDL_PRESSED, SDLK_SPACE },
+		{ 190, SDL_PRESSED, SDLK_DOWN },
+		{ 210, SDL_RELEASED, SDLK_DOWN },
+		{ 210, SDL_PRESSED, SDLK_a },
+	};
+	static const Uint32 Period = 240;
+
+	const Uint32 t = (Uint32)(tick % Period);
+	for(const Step& step : Script)
+	{
+		if(step.tick != t) continue;
+		SDL_Event e;
+		SDL_zero(e);
+		e.type = step.state == SDL_PRESSED? SDL_KEYDOWN: SDL_KEYUP;
+		e.key.state = step.state;
+		e.key.keysym.sym = step.key;
+		ProcessEvent(e);
+	}
+}
+
+
+int Game::RunBenchmark(const vector<size_t>& counts, unsigned int ticks)
+{
+	//The player must last the whole run
+	const int PlayerHealth = 1000000;
+	const double msPerCount = 1000.0 / SDL_GetPerformanceFrequency();
+	const RectF screen(0.0f, 0.0f, (float)clientWidth_, (float)clientHeight_);
+	if(ticks == 0) ticks = 1;
+
+	//Every count gets its own stream of the run's seed: same seed, same numbers
+	const Uint64 seed = __WHEEL.GetSeed();
+	printf("Seed: %llu\n", (unsigned long long)seed);
+
+	batch->SetDryRun(true);
+	printf("%8s %8s %10s %10s %12s %10s\n", "enemies", "objects", "update ms", "draw ms", "allocs/tick", "ticks/sec");
+	for(const size_t count : counts)
+	{
+		__WHEEL.Seed(seed, count);
+		SetStress(StressConfig::Scaled(count));
+		currentLevel = 0;
+		LoadNextLevel();
+		leftDown = rightDown = upDown = downDown = false;
+		const size_t objects = world->Count();
+
+		Uint64 updateCounts = 0, drawCounts = 0, allocs = 0;
+		for(unsigned int tick = 0; tick < ticks && !quit_; ++tick)
+		{
+			player->SetHealth(PlayerHealth);
+			ScriptInput(tick);
+
+			const Uint64 allocsBefore = Allocations::Count();
+			const Uint64 start = SDL_GetPerformanceCounter();
+			Update();
+			const Uint64 updated = SDL_GetPerformanceCounter();
+			batch->ResetStats();
+			world->Draw(*batch, screen, camera.X());
+			const Uint64 drawn = SDL_GetPerformanceCounter();
+
+			allocs += Allocations::Count() - allocsBefore;
+			updateCounts += updated - start;
+			drawCounts += drawn - updated;
+		}
+
+		const double updateMs = updateCounts * msPerCount / ticks;
+		const double drawMs = drawCounts * msPerCount / ticks;
+		const double tps = updateMs + drawMs > 0.0? 1000.0 / (updateMs + drawMs): 0.0;
+		printf("%8lu %8lu %10.3f %10.3f %12.1f %10.1f\n", (unsigned long)count, (unsigned long)objects
+			, updateMs, drawMs, (double)allocs / ticks, tps);
+	}
+	batch->SetDryRun(false);
+	SetStress(StressConfig());
+	return 0;
+}
+
+
+bool Game::CheckDeterminism(size_t count, unsigned int ticks)
+{
+	const Uint64 seed = __WHEEL.GetSeed();
+	Uint32 checksums[2];
+	for(Uint32& checksum : checksums)
+	{
+		//Same start both times: the world goes first, it refers to the player
+		world.reset();
+		player = make_unique<Player>(renderer());
+		__WHEEL.Seed(seed);
+		clock.Reset();
+		SetStress(StressConfig::Scaled(count));
+		currentLevel = 0;
+		LoadNextLevel();
+		leftDown = rightDown = upDown = downDown = false;
+		for(unsigned int tick = 0; tick < ticks && !quit_; ++tick)
+		{
+			ScriptInput(tick);
+			Update();
+		}
+		checksum = StateChecksum();
+	}
+	SetStress(StressConfig());
+
+	const bool matched = checksums[0] == checksums[1];
+	printf("Self-test: %-24s %s (%08x/%08x after %u ticks, seed %llu)\n", "Determinism", matched? "ok": "FAILED"
+		, checksums[0], checksums[1], ticks, (unsigned long long)seed);
+	return matched;
+}
+
+
+//Zero-alloc check over a tick or a frame: anything allocating inside it
+//(outside AllowAllocations scopes) is logged and counted as a failure
+struct ZeroAllocCheck
+{
+	ZeroAllocCheck(bool enabled_, const char* what_, Uint64 tick_, Uint64& failures_)
+		: enabled(enabled_), what(what_), tick(tick_), failures(failures_)
+		, before(Allocations::Violations())
+	{
+		if(enabled) Allocations::ExpectNone(true);
+	}
+
+	~ZeroAllocCheck()
+	{
+		if(!enabled) return;
+		Allocations::ExpectNone(false);
+		const Uint64 n = Allocations::Violations() - before;
+		if(n == 0) return;
+		++failures;
+		logError("Zero-alloc: %s of tick %llu made %llu allocation(s), last in %s"
+			, what, (unsigned long long)tick, (unsigned long long)n, Allocations::LastViolation());
+	}
+
+	const bool enabled;
+	const char* const what;
+	const Uint64 tick;
+	Uint64& failures;
+	const Uint64 before;
+};
+
+
 void Game::Update()
 {
+	ZeroAllocCheck zeroAlloc(ZeroAllocChecking(), "update", clock.Ticks(), zeroAllocFailures);
+
+	//Replay: the actions recorded for this tick, then stop where the recording did
+	if(recording.IsPlaying())
+	{
+		InputRecording::Action action;
+		while(recording.Next(clock.Ticks(), action))
+			Act(action);
+		if(recording.Ended(clock.Ticks()))
+		{
+			quit_ = true;
+			return;
+		}
+	}
+
+	//Paused - hold everything where it is (nothing to interpolate either)
+	if(clock.IsPaused())
+	{
+		world->SavePositions();
+		camera.SavePosition();
+		return;
+	}
+	clock.Tick();
+
 	//Level management
 	if(player->IsDead())
 	{
 		//TODO
 		logPrintf("GAME OVER!");
+		leftDown = rightDown = upDown = downDown = false;
+		//a headless round ends here (a replay ends where the recording did)
+		if(IsHeadless() && !recording.IsPlaying()) quit_ = true;
 		//end the game
 		//try again? yes/no
 		//Resurrect player
 	}
 	else if(LevelComplete())
 	{
-		logPrintf("Level{%lu} Completed", currentLevel);
+		logPrintf("Level{%lu} Completed", (unsigned long)currentLevel);
 
 		if(currentLevel == MaxLevel)
 		{
@@ -230,6 +692,7 @@ void Game::Update()
 			//end the game
 			//Play end credits
 			logPrintf("*** GAME COMPLETED ***");
+			if(IsHeadless() && !recording.IsPlaying()) quit_ = true;
 			return;
 		}
 		else
@@ -238,6 +701,10 @@ void Game::Update()
 		}
 	}
 
+	//Previous simulation state (render interpolation)
+	world->SavePositions();
+	camera.SavePosition();
+
 	//Gameplay
 	//Update movement vectors
 	if (upDown) player->GoUp();
@@ -247,17 +714,35 @@ void Game::Update()
 	bg->SetScroll(player->GetState() == PlayerState::Walking
 		|| player->GetState() == PlayerState::Jumping);
 
-	//text
-	std::stringstream ss;
-	ss << "FPS: " << Fps();
-	tbFps->SetText(ss.str());
-	ss.str("");
-	ss.clear();
-	ss << "Pos: {" << (int)player->Position().x 
-		<< "," << (int)player->Position().y 
-		<< "," << (int)player->Position().z 
-		<< "}  Health: " << player->GetHealth();
-	tbPlayerPos->SetText(ss.str());
+	//text (nobody to read it when headless)
+	if(!IsHeadless())
+	{
+		ALLOC_TAG("HUD text");
+		const Workers::Stats jobs = workers().TotalStats();
+		HudValues now;
+		SDL_zero(now); //padding too, for the memcmp
+		now.fps = Fps();
+		now.drawCalls = batch->DrawCalls(), now.quads = batch->Quads();
+		now.drawn = world->Drawn(), now.culled = world->Culled();
+		now.awake = awakeEnemies, now.enemies = enemies.Count();
+		now.tasks = jobs.tasks, now.steals = jobs.steals;
+		now.x = (int)player->Position().x;
+		now.y = (int)player->Position().y;
+		now.z = (int)player->Position().z;
+		now.health = player->GetHealth();
+		if(memcmp(&now, &hud, sizeof(hud)) != 0)
+		{
+			memcpy(&hud, &now, sizeof(hud));
+			snprintf(hudLine, sizeof(hudLine), "FPS: %g  Draw calls: %u  Quads: %u  Drawn: %u  Culled: %u"
+				"  Awake: %u/%u  Tasks: %llu (%llu stolen)",
+				hud.fps, (unsigned)hud.drawCalls, (unsigned)hud.quads, (unsigned)hud.drawn, (unsigned)hud.culled,
+				(unsigned)hud.awake, (unsigned)hud.enemies,
+				(unsigned long long)hud.tasks, (unsigned long long)hud.steals);
+			tbFps->SetText(hudLine);
+			snprintf(hudLine, sizeof(hudLine), "Pos: {%d,%d,%d}  Health: %d", hud.x, hud.y, hud.z, hud.health);
+			tbPlayerPos->SetText(hudLine);
+		}
+	}
 	//ss.str("");
 	//ss.clear();
 	//ss << "Enemy Pos: {" << (int)andore->Position().x 
@@ -268,14 +753,57 @@ void Game::Update()
 
 
 	//Other game logic
-	world->Update();
+	{
+		PROFILE_SCOPE(Profiler::PH_Update);
+		//Scrolling moves the camera (the background scrolling left = looking further right)
+		//The player is carried along so it keeps its place on screen
+		if(bg->IsScrolling())
+		{
+			const float dx = bg->GetDirection() == Direction::Left? bg->GetSpeedX(): -bg->GetSpeedX();
+			camera.Scroll(dx);
+			player->Position().x += dx;
+		}
+		WakeEnemies();
+		world->Update(MoveBounds.top(), workers());
+	}
+
+	//A few times a second is plenty
+	if(showProfiler && !IsHeadless() && clock.Ticks() % 15 == 0)
+	{
+		UpdateProfilerOverlay();
+	}
+}
+
+
+void Game::UpdateProfilerOverlay()
+{
+	char line[128];
+	for(int phase = 0; phase < Profiler::PH_Count; ++phase)
+	{
+		const Profiler::PhaseStats stats = PROFILER.Stats((Profiler::Phase)phase);
+		snprintf(line, sizeof(line), "%-8s p50 %6.2f  p99 %6.2f  max %6.2f ms  %6.1f allocs"
+			, Profiler::PhaseName((Profiler::Phase)phase), stats.p50, stats.p99, stats.max, stats.allocs);
+		tbProfile[phase]->SetText(line);
+		tbProfile[phase]->Update();
+	}
 }
 
 
 void Game::Render()
 {
+	ZeroAllocCheck zeroAlloc(ZeroAllocChecking(), "render", clock.Ticks(), zeroAllocFailures);
 	//SDL_RenderClear( renderer_ );
-	world->Draw(renderer());
+	batch->ResetStats();
+	world->Draw(*batch, RectF(0.0f, 0.0f, (float)clientWidth_, (float)clientHeight_), camera.RenderX(Alpha()));
+
+	if(showProfiler)
+	{
+		for(const auto& tb : tbProfile)
+			tb->Draw(*batch);
+		batch->Flush();
+	}
+
+	PROFILE_SCOPE(Profiler::PH_Present);
 	SDL_RenderPresent( &renderer() );
 }
 
@@ -29,3 +29,14 @@ void GameObject::AdjustZToGameDepth()
 { 
 	position.z = position.y - GAME.MoveBounds.top();
 }
+
+
+RectF GameObject::Interpolate(const RectF& rect) const
+{
+	//alpha 1 = current simulation state, 0 = previous
+	const float lag = 1.0f - GAME.Alpha();
+	RectF r(rect);
+	r.x += (prevPosition.x - position.x) * lag;
+	r.y += (prevPosition.y - position.y) * lag;
+	return r;
+}
@@ -0,0 +1,190 @@
+#include "InputRecording.h"
+#include "Util.h"
+#include "Allocations.h"
+#include <stdio.h>
+#include <string.h>
+
+
+using namespace std;
+using namespace util;
+
+
+static const char Magic[4] = { 'B', 'E', 'U', 'R' };
+static const Uint8 Version = 1;
+
+
+static void WriteU(FILE* file, Uint64 value, int bytes)
+{
+	for(int i = 0; i < bytes; ++i)
+		fputc((int)((value >> (8 * i)) & 0xFF), file);
+}
+
+
+static bool ReadU(FILE* file, Uint64& value, int bytes)
+{
+	value = 0;
+	for(int i = 0; i < bytes; ++i)
+	{
+		const int c = fgetc(file);
+		if(c == EOF) return false;
+		value |= (Uint64)c << (8 * i);
+	}
+	return true;
+}
+
+
+//7 bits at a time, low first, high bit set = more to come
+static void WriteVarint(FILE* file, Uint64 value)
+{
+	while(value >= 0x80)
+	{
+		fputc((int)(value & 0x7F) | 0x80, file);
+		value >>= 7;
+	}
+	fputc((int)value, file);
+}
+
+
+static bool ReadVarint(FILE* file, Uint64& value)
+{
+	value = 0;
+	for(int shift = 0; shift < 64; shift += 7)
+	{
+		const int c = fgetc(file);
+		if(c == EOF) return false;
+		value |= (Uint64)(c & 0x7F) << shift;
+		if(!(c & 0x80)) return true;
+	}
+	return false;
+}
+
+
+InputRecording::InputRecording()
+	: cursor(0)
+	, seed(0)
+	, endTick(0)
+	, checksum(0)
+	, mode(M_Off)
+{
+}
+
+
+void InputRecording::Start(Uint64 seed_)
+{
+	entries.clear();
+	entries.reserve(4096);
+	cursor = 0;
+	seed = seed_;
+	endTick = 0;
+	checksum = 0;
+	mode = M_Recording;
+}
+
+
+void InputRecording::Record(Uint64 tick, Action action)
+{
+	if(mode != M_Recording) return;
+	//The list only grows now and then - not a steady state allocation
+	AllowAllocations allow;
+	ALLOC_TAG("InputRecording");
+	entries.push_back(Entry{ tick, action });
+}
+
+
+void InputRecording::Finish(Uint64 endTick_, Uint32 checksum_)
+{
+	endTick = endTick_;
+	checksum = checksum_;
+}
+
+
+bool InputRecording::Save(const string& fileName) const
+{
+	unique_ptr2<FILE> file(fopen(fileName.c_str(), "wb"), [](FILE* f) { if(f) fclose(f); });
+	if(!file)
+	{
+		logError("InputRecording: unable to write %s", fileName.c_str());
+		return false;
+	}
+
+	fwrite(Magic, 1, sizeof(Magic), file.get());
+	WriteU(file.get(), Version, 1);
+	WriteU(file.get(), seed, 8);
+	WriteU(file.get(), endTick, 8);
+	WriteU(file.get(), checksum, 4);
+	WriteU(file.get(), entries.size(), 4);
+
+	Uint64 previous = 0;
+	for(const Entry& entry : entries)
+	{
+		WriteVarint(file.get(), entry.tick - previous);
+		WriteU(file.get(), entry.action, 1);
+		previous = entry.tick;
+	}
+
+	logPrintf("InputRecording: %lu actions over %llu ticks written to %s"
+		, (unsigned long)entries.size(), (unsigned long long)endTick, fileName.c_str());
+	return true;
+}
+
+
+bool InputRecording::Load(const string& fileName)
+{
+	unique_ptr2<FILE> file(fopen(fileName.c_str(), "rb"), [](FILE* f) { if(f) fclose(f); });
+	if(!file)
+	{
+		logError("InputRecording: unable to read %s", fileName.c_str());
+		return false;
+	}
+
+	char magic[sizeof(Magic)];
+	Uint64 version, count, value;
+	if(fread(magic, 1, sizeof(magic), file.get()) != sizeof(magic) || memcmp(magic, Magic, sizeof(Magic)) != 0
+		|| !ReadU(file.get(), version, 1) || version != Version)
+	{
+		logError("InputRecording: %s is not a recording (version %u)", fileName.c_str(), (unsigned)Version);
+		return false;
+	}
+
+	Uint64 seed_, endTick_;
+	if(!ReadU(file.get(), seed_, 8) || !ReadU(file.get(), endTick_, 8)
+		|| !ReadU(file.get(), value, 4) || !ReadU(file.get(), count, 4))
+	{
+		logError("InputRecording: %s is truncated", fileName.c_str());
+		return false;
+	}
+
+	vector<Entry> loaded;
+	loaded.reserve((size_t)count);
+	Uint64 tick = 0;
+	for(Uint64 i = 0; i < count; ++i)
+	{
+		Uint64 delta, action;
+		if(!ReadVarint(file.get(), delta) || !ReadU(file.get(), action, 1) || action >= A_Count)
+		{
+			logError("InputRecording: %s is corrupt at action %llu", fileName.c_str(), (unsigned long long)i);
+			return false;
+		}
+		tick += delta;
+		loaded.push_back(Entry{ tick, (Action)action });
+	}
+
+	entries.swap(loaded);
+	cursor = 0;
+	seed = seed_;
+	endTick = endTick_;
+	checksum = (Uint32)value;
+	mode = M_Playing;
+	logPrintf("InputRecording: %lu actions over %llu ticks read from %s (seed %llu)"
+		, (unsigned long)entries.size(), (unsigned long long)endTick, fileName.c_str(), (unsigned long long)seed);
+	return true;
+}
+
+
+bool InputRecording::Next(Uint64 tick, Action& action)
+{
+	if(mode != M_Playing || cursor == entries.size() || entries[cursor].tick > tick)
+		return false;
+	action = entries[cursor++].action;
+	return true;
+}
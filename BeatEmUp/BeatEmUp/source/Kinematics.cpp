@@ -0,0 +1,139 @@
+#include "Kinematics.h"
+#include "GameObject.h"
+#include <utility>
+
+
+
+
+Kinematics::Kinematics(size_t initialCapacity)
+	: awake(0)
+{
+	x.reserve(initialCapacity), y.reserve(initialCapacity), z.reserve(initialCapacity);
+	xVel.reserve(initialCapacity), yVel.reserve(initialCapacity);
+	grounded.reserve(initialCapacity);
+	owners.reserve(initialCapacity);
+}
+
+
+void Kinematics::Add(GameObject& object)
+{
+	if(object.kinematicId >= 0) return;
+
+	object.kinematicId = (int)owners.size();
+	owners.push_back(&object);
+	x.push_back(object.position.x);
+	y.push_back(object.position.y);
+	z.push_back(object.position.z);
+	xVel.push_back(object.xVel);
+	yVel.push_back(object.yVel);
+	grounded.push_back(1);
+
+	//Awake: join the front part
+	Swap(object.kinematicId, awake++);
+}
+
+
+void Kinematics::SetAwake(GameObject& object, bool value)
+{
+	const int id = object.kinematicId;
+	if(id < 0 || ((size_t)id < awake) == value) return;
+
+	//The row trades places with the first sleeping one (waking up) or the
+	//last awake one (falling asleep), and the boundary moves over it
+	if(value) Swap(id, awake++);
+	else Swap(id, --awake);
+}
+
+
+void Kinematics::Swap(size_t a, size_t b)
+{
+	if(a == b) return;
+	std::swap(x[a], x[b]), std::swap(y[a], y[b]), std::swap(z[a], z[b]);
+	std::swap(xVel[a], xVel[b]), std::swap(yVel[a], yVel[b]);
+	std::swap(grounded[a], grounded[b]);
+	std::swap(owners[a], owners[b]);
+	owners[a]->kinematicId = (int)a;
+	owners[b]->kinematicId = (int)b;
+}
+
+
+void Kinematics::Remove(GameObject& object)
+{
+	const int id = object.kinematicId;
+	if(id < 0 || (size_t)id >= owners.size() || owners[id] != &object) return;
+
+	//Out of the awake part first, then swap with the last one, keeping the arrays dense
+	SetAwake(object, false);
+	Swap(object.kinematicId, owners.size() - 1);
+
+	x.pop_back(), y.pop_back(), z.pop_back();
+	xVel.pop_back(), yVel.pop_back();
+	grounded.pop_back();
+	owners.pop_back();
+	object.kinematicId = -1;
+}
+
+
+void Kinematics::Clear()
+{
+	for(const auto owner : owners)
+		owner->kinematicId = -1;
+
+	x.clear(), y.clear(), z.clear();
+	xVel.clear(), yVel.clear();
+	grounded.clear();
+	owners.clear();
+	awake = 0;
+}
+
+
+void Kinematics::Gather()
+{
+	const size_t count = awake;
+	for(size_t i = 0; i < count; ++i)
+	{
+		const GameObject& object = *owners[i];
+		x[i] = object.position.x;
+		y[i] = object.position.y;
+		z[i] = object.position.z;
+		xVel[i] = object.xVel;
+		yVel[i] = object.yVel;
+		grounded[i] = object.Grounded()? 1: 0;
+	}
+}
+
+
+void Kinematics::Integrate(float groundTop)
+{
+	const size_t count = awake;
+
+	for(size_t i = 0; i < count; ++i)
+		x[i] += xVel[i];
+
+	for(size_t i = 0; i < count; ++i)
+		y[i] += yVel[i];
+
+	//Z rules dont apply to jumping
+	for(size_t i = 0; i < count; ++i)
+	{
+		if(!grounded[i]) continue;
+		y[i] = y[i] < groundTop? groundTop: y[i];
+		z[i] = y[i] - groundTop;
+	}
+}
+
+
+void Kinematics::WriteBack()
+{
+	const size_t count = awake;
+	for(size_t i = 0; i < count; ++i)
+	{
+		GameObject& object = *owners[i];
+		object.position.x = x[i];
+		object.position.y = y[i];
+		object.position.z = z[i];
+	}
+
+	for(size_t i = 0; i < count; ++i)
+		owners[i]->OnIntegrated();
+}
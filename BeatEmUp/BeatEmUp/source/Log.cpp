@@ -0,0 +1,186 @@
+#include "Log.h"
+#include <stdlib.h>
+#include <chrono>
+
+
+using namespace std;
+
+
+Logger& Logger::Instance()
+{
+	static Logger* const logger = new Logger();
+	return *logger;
+}
+
+
+Logger::Logger()
+	: ring(new Record[Capacity])
+	, enqueuePos(0)
+	, dequeuePos(0)
+	, written(0)
+	, dropped(0)
+	, running(true)
+	, epoch(SDL_GetPerformanceCounter())
+	, msPerCount(1000.0 / SDL_GetPerformanceFrequency())
+{
+	for(size_t i = 0; i < Capacity; ++i)
+		ring[i].sequence.store(i, memory_order_relaxed);
+
+	thread = std::thread(&Logger::Consume, this);
+	//Drain and fall back to direct writes before the statics that log on their way out are gone
+	atexit([] { Instance().Stop(); });
+}
+
+
+//Multi-producer slot reservation (bounded MPMC queue, D. Vyukov)
+//A slot is free for position p when its sequence is p, and holds a record
+//for the reader once it is p + 1
+Logger::Record* Logger::Acquire(size_t& position)
+{
+	position = enqueuePos.load(memory_order_relaxed);
+	for(;;)
+	{
+		Record& record = ring[position & (Capacity - 1)];
+		const size_t sequence = record.sequence.load(memory_order_acquire);
+		const ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)position;
+		if(diff == 0)
+		{
+			if(enqueuePos.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+				return &record;
+		}
+		else if(diff < 0)
+		{
+			//Full - the writer is behind
+			++dropped;
+			return nullptr;
+		}
+		else
+		{
+			position = enqueuePos.load(memory_order_relaxed);
+		}
+	}
+}
+
+
+void Logger::Consume()
+{
+	for(;;)
+	{
+		bool wrote = false;
+		for(;;)
+		{
+			Record& record = ring[dequeuePos & (Capacity - 1)];
+			if(record.sequence.load(memory_order_acquire) != dequeuePos + 1) break;
+			Output(record);
+			record.sequence.store(dequeuePos + Capacity, memory_order_release);
+			++dequeuePos;
+			written.store(dequeuePos, memory_order_release);
+			wrote = true;
+		}
+
+		if(wrote) fflush(stderr);
+		else if(!running && dequeuePos == enqueuePos.load()) return;
+		else this_thread::sleep_for(chrono::milliseconds(1));
+	}
+}
+
+
+void Logger::Flush()
+{
+	const size_t target = enqueuePos.load();
+	while(running && written.load(memory_order_acquire) < target)
+		this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+
+void Logger::Stop()
+{
+	if(!running) return;
+	running = false;
+	thread.join();
+	Drain();
+	if(dropped)
+		fprintf(stderr, "Logger: %llu records dropped (ring full)\n", (unsigned long long)dropped.load());
+}
+
+
+//Anything published after the consumer's last look (or still being written
+//by a thread that got its slot before Stop) goes out here, in order
+void Logger::Drain()
+{
+	lock_guard<mutex> lock(drainMutex);
+	const size_t end = enqueuePos.load();
+	while(dequeuePos != end)
+	{
+		Record& record = ring[dequeuePos & (Capacity - 1)];
+		if(record.sequence.load(memory_order_acquire) != dequeuePos + 1)
+		{
+			this_thread::yield(); //its writer is still filling it in
+			continue;
+		}
+		Output(record);
+		record.sequence.store(dequeuePos + Capacity, memory_order_release);
+		++dequeuePos;
+		written.store(dequeuePos, memory_order_release);
+	}
+	fflush(stderr);
+}
+
+
+//printf, one conversion at a time, each with the argument as it was logged
+void Logger::Output(const Record& record)
+{
+	static const char LevelNames[] = "TDIWE";
+	char line[1024];
+	const size_t Last = sizeof(line) - 1; //room for the newline
+	size_t length = 0;
+	auto advance = [&](int n) { if(n > 0) length = SDL_min(length + (size_t)n, Last); };
+
+	advance(snprintf(line, Last, "%10.3f %c ", (record.counter - epoch) * msPerCount, LevelNames[record.level]));
+
+	Uint8 arg = 0;
+	for(const char* f = record.format; *f && length < Last;)
+	{
+		if(*f != '%')
+		{
+			line[length++] = *f++;
+			continue;
+		}
+		if(f[1] == '%')
+		{
+			line[length++] = '%';
+			f += 2;
+			continue;
+		}
+
+		//%[flags][width][.precision][length]conversion
+		const char* start = f++;
+		while(*f && !strchr("diouxXeEfFgGaAcsp", *f)) ++f;
+		if(!*f) break;
+		char spec[32];
+		const size_t specLength = SDL_min((size_t)(f - start + 1), sizeof(spec) - 1);
+		memcpy(spec, start, specLength);
+		spec[specLength] = '\0';
+		++f;
+		if(arg >= record.argCount) continue;
+
+		char* out = line + length;
+		const size_t room = Last - length + 1;
+		const Value& v = record.values[arg];
+		switch(record.types[arg++])
+		{
+		case A_Int:		advance(snprintf(out, room, spec, (int)v.i)); break;
+		case A_UInt:	advance(snprintf(out, room, spec, (unsigned int)v.u)); break;
+		case A_Long:	advance(snprintf(out, room, spec, (long)v.i)); break;
+		case A_ULong:	advance(snprintf(out, room, spec, (unsigned long)v.u)); break;
+		case A_LLong:	advance(snprintf(out, room, spec, v.i)); break;
+		case A_ULLong:	advance(snprintf(out, room, spec, v.u)); break;
+		case A_Double:	advance(snprintf(out, room, spec, v.d)); break;
+		case A_String:	advance(snprintf(out, room, spec, record.strings + v.offset)); break;
+		case A_Pointer:	advance(snprintf(out, room, spec, v.p)); break;
+		}
+	}
+
+	line[length++] = '\n';
+	fwrite(line, 1, length, stderr);
+}
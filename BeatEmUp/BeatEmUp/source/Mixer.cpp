@@ -10,7 +10,7 @@ void LoadChunk(Mixer& mixer, Mixer::SoundEffect effect, const string& file)
 {
 	if(mixer.effects.find(effect) != mixer.effects.end())
 	{
-		logPrintf( "Sound effect <%s> already loaded!", file.c_str() );
+		logWarn( "Sound effect <%s> already loaded!", file.c_str() );
 		return;
 	}
 
@@ -18,11 +18,11 @@ void LoadChunk(Mixer& mixer, Mixer::SoundEffect effect, const string& file)
 	if(chunk)
 	{
 		mixer.effects[effect] = chunk;
-		logPrintf("Loaded soundeffect: %s", file.c_str());
+		logTrace("Loaded soundeffect: %s", file.c_str());
 	}
 	else
 	{
-		logPrintf( "Failed to load '%s' sound effect! SDL_mixer Error: %s", file.c_str(), Mix_GetError() );
+		logError( "Failed to load '%s' sound effect! SDL_mixer Error: %s", file.c_str(), Mix_GetError() );
 	}
 }
 
@@ -36,6 +36,13 @@ void LoadMusic(Mixer& mixer, Mixer::SoundTrack track, const string& file)
 Mixer::Mixer()
 	: currentTrack(nullptr)
 {
+	//No audio device (e.g. headless mode) - nothing to load, Play() is a no-op
+	if(!Mix_QuerySpec(nullptr, nullptr, nullptr))
+	{
+		logWarn("Audio device not open. Sound disabled");
+		return;
+	}
+
 	//Load sound effects
 	LoadChunk(*this, SE_Kick, "resources/kick.wav");
 	LoadChunk(*this, SE_Punch, "resources/punch.wav");
@@ -89,7 +96,7 @@ void Mixer::Play(Mixer::SoundTrack track)
 		}
 		else
 		{
-			logPrintf( "Failed to load track '%s'! SDL_mixer Error: %s", it->second.c_str(), Mix_GetError() );
+			logError( "Failed to load track '%s'! SDL_mixer Error: %s", it->second.c_str(), Mix_GetError() );
 		}
 	}
 }
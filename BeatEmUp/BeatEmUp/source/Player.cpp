@@ -23,6 +23,10 @@ Player::Player(SDL_Renderer& renderer)
 	,	hitRight(Sprite::FromFile("resources/baddude_hitright.png", renderer, 70, 108, 5, 0))
 	,	fallLeft(Sprite::FromFile("resources/baddude_fallleft.png", renderer, 133, 121, 1, 0))
 	,	fallRight(Sprite::FromFile("resources/baddude_fallright.png", renderer, 133, 121, 1, 0))
+	, punchLeftToken(events::NoToken)
+	, punchRightToken(events::NoToken)
+	, kickLeftToken(events::NoToken)
+	, kickRightToken(events::NoToken)
 	, current(nullptr)
 	, jumpState(JumpState::Ground)
 	, pState(PlayerState::Idle)
@@ -36,10 +40,10 @@ Player::Player(SDL_Renderer& renderer)
 	position.y = (float)GAME.MidSectionY((int)position.h);
 	position.z = position.y - GAME.MoveBounds.top();
 
-	punchRight->FramePlayed.attach(*this, &Player::OnPunchSprite);
-	punchLeft->FramePlayed.attach(*this, &Player::OnPunchSprite);
-	kickRight->FramePlayed.attach(*this, &Player::OnKickSprite);
-	kickLeft->FramePlayed.attach(*this, &Player::OnKickSprite);
+	punchRightToken = punchRight->FramePlayed.attach(*this, &Player::OnPunchSprite);
+	punchLeftToken = punchLeft->FramePlayed.attach(*this, &Player::OnPunchSprite);
+	kickRightToken = kickRight->FramePlayed.attach(*this, &Player::OnKickSprite);
+	kickLeftToken = kickLeft->FramePlayed.attach(*this, &Player::OnKickSprite);
 
 	SetDirection(Direction::Right);
 	Stop();
@@ -48,13 +52,13 @@ Player::Player(SDL_Renderer& renderer)
 
 Player::~Player()
 {
-	punchLeft->FramePlayed.detach(*this, &Player::OnPunchSprite);
-	punchRight->FramePlayed.detach(*this, &Player::OnPunchSprite);
-	kickRight->FramePlayed.detach(*this, &Player::OnKickSprite);
-	kickLeft->FramePlayed.detach(*this, &Player::OnKickSprite);
+	punchLeft->FramePlayed.detach(punchLeftToken);
+	punchRight->FramePlayed.detach(punchRightToken);
+	kickRight->FramePlayed.detach(kickRightToken);
+	kickLeft->FramePlayed.detach(kickLeftToken);
 
 	current = nullptr;
-	logPrintf("Player object released");
+	logTrace("Player object released");
 }
 
 
@@ -62,18 +66,19 @@ void Player::OnPunchSprite(const Sprite& sender, const Sprite::FramePlayedEventA
 {
 	if(e.FrameIndex == 1 || e.FrameIndex == 4 || e.FrameIndex == 8)
 	{
+		Combat& combat = GAME.world->combat;
 		bool hit = false;
-		for(const auto enemy : GAME.enemies)
+		GAME.enemyGrid.ForEachOverlapping(*this, [&](Enemy* enemy)
 		{
-			if(enemy->IsAttackable() && CollidedWith(*enemy) && GetDirection() != enemy->GetDirection())
+			if(enemy->IsAttackable() && GetDirection() != enemy->GetDirection())
 			{
-				enemy->OnHit();
+				combat.Hit(*this, *enemy);
 				hit = true;
 			}
-		}
+		});
 
-		if(hit)		MIXER.Play(Mixer::SE_PunchHit);
-		else 			MIXER.Play(Mixer::SE_Punch);
+		if(hit)		combat.Sound(*this, Mixer::SE_PunchHit);
+		else 			combat.Sound(*this, Mixer::SE_Punch);
 	}
 }
 
@@ -82,18 +87,19 @@ void Player::OnKickSprite(const Sprite& sender, const Sprite::FramePlayedEventAr
 {
 	if(e.FrameIndex == 1)
 	{
+		Combat& combat = GAME.world->combat;
 		bool hit = false;
-		for(const auto enemy : GAME.enemies)
+		GAME.enemyGrid.ForEachOverlapping(*this, [&](Enemy* enemy)
 		{
-			if(enemy->IsAttackable() && CollidedWith(*enemy) && GetDirection() != enemy->GetDirection())
+			if(enemy->IsAttackable() && GetDirection() != enemy->GetDirection())
 			{
-				enemy->OnHit();
+				combat.Hit(*this, *enemy);
 				hit = true;
 			}
-		}
+		});
 
-		if(hit)		MIXER.Play(Mixer::SE_Kick);
-		else 			MIXER.Play(Mixer::SE_Punch);
+		if(hit)		combat.Sound(*this, Mixer::SE_Kick);
+		else 			combat.Sound(*this, Mixer::SE_Punch);
 	}
 }
 
@@ -122,7 +128,7 @@ void Player::OnHit(Uint8 damage)
 
 		if(GetHealth() > 0 && hitCount < KnockDownHitCount)
 		{
-			recoveryTimer = SDL_GetTicks() + 300;
+			recoveryTimer = GAME.clock.Now() + 300;
 		}
 		else
 		{
@@ -143,8 +149,8 @@ void Player::OnKnockDown()
 			jumpState = JumpState::Landing;
 		if(position.y <= jumpLocation.y) jumpState = JumpState::Landing;
 
-		if( (position.right() + xVel >= GAME.MoveBounds.right() - position.w)
-			|| (position.left() + xVel <= GAME.MoveBounds.x))
+		if( (position.right() + xVel >= GAME.WorldMoveBounds().right() - position.w)
+			|| (position.left() + xVel <= GAME.WorldMoveBounds().x))
 				xVel = 0;
 	}
 	//Landing (in the air)..
@@ -154,8 +160,8 @@ void Player::OnKnockDown()
 		if(position.y < jumpLocation.y)
 		{
 			yVel += Gravity;
-			if( (position.right() + (xVel + 0.15f) >= GAME.MoveBounds.right() - position.w)
-				|| (position.left() + (xVel - 0.15f)  <= GAME.MoveBounds.x))
+			if( (position.right() + (xVel + 0.15f) >= GAME.WorldMoveBounds().right() - position.w)
+				|| (position.left() + (xVel - 0.15f)  <= GAME.WorldMoveBounds().x))
 					xVel = 0;
 			else
 				xVel += GetDirection() == Direction::Right? 0.15f: -0.15f;
@@ -180,17 +186,17 @@ void Player::OnKnockDown()
 			if(current->GetCurrentFrame() == 1)
 			{
 				if(recoveryTimer == 0) {
-					recoveryTimer = SDL_GetTicks() + 2000;
-				} else if (SDL_GetTicks() > recoveryTimer) {
+					recoveryTimer = GAME.clock.Now() + 2000;
+				} else if (GAME.clock.Now() > recoveryTimer) {
 					current->SetCurrentFrame(2);
-					recoveryTimer = SDL_GetTicks() + 500;
+					recoveryTimer = GAME.clock.Now() + 500;
 				}
 			}
 			//Half up...
 			else if(current->GetCurrentFrame() == 2)
 			{
 				//full up.. go to idle..
-				if(SDL_GetTicks() > recoveryTimer) {
+				if(GAME.clock.Now() > recoveryTimer) {
 					Stop();
 					recoveryTimer = 0;
 				}
@@ -272,7 +278,7 @@ void Player::Update()
 	}
 
 	//Recovery (when hit)
-	if(pState == PlayerState::Hit && SDL_GetTicks() > recoveryTimer)
+	if(pState == PlayerState::Hit && GAME.clock.Now() > recoveryTimer)
 	{
 		Stop();
 		recoveryTimer = 0;
@@ -282,7 +288,7 @@ void Player::Update()
 	//punching
 	if(pState == PlayerState::Punching)
 	{
-		if(SDL_GetTicks() > punchTimeout) {
+		if(GAME.clock.Now() > punchTimeout) {
 			Stop(); //sets pState to PlayerState::Idle
 			punchTimeout = 0;
 		}
@@ -291,7 +297,7 @@ void Player::Update()
 	//kicking
 	if(pState == PlayerState::Kicking)
 	{
-		if(SDL_GetTicks() > kickTimeout) {
+		if(GAME.clock.Now() > kickTimeout) {
 			Stop(); //sets pState to PlayerState::Idle
 			kickTimeout = 0;
 		}
@@ -315,9 +321,9 @@ void Player::Update()
 }
 
 
-void Player::Draw(SDL_Renderer& renderer) const
+void Player::Draw(SpriteBatch& batch) const
 {
-	current->Draw(renderer);
+	current->Draw(batch, Interpolate(current->Position()));
 }
 
 
@@ -373,7 +379,7 @@ void Player::Punch()
 		current = GetDirection()==Direction::Right? punchRight.get(): punchLeft.get();
 		current->SetAnimation(true);
 		current->SetCurrentFrame(0);
-		punchTimeout = SDL_GetTicks() + 250;
+		punchTimeout = GAME.clock.Now() + 250;
 		pState = PlayerState::Punching;
 	}
 }
@@ -385,7 +391,7 @@ void Player::Kick()
 
 	current = GetDirection() == Direction::Right? kickRight.get(): kickLeft.get();
 	current->SetAnimation(true);
-	kickTimeout = SDL_GetTicks() + 250;
+	kickTimeout = GAME.clock.Now() + 250;
 	pState = PlayerState::Kicking;
 }
 
@@ -464,7 +470,7 @@ void Player::GoRight()
 
 	current = GetDirection() == Direction::Right? walkRight.get(): walkLeft.get();
 
-	if (position.x <= GAME.MoveBounds.right() - position.w) 
+	if (position.x <= GAME.WorldMoveBounds().right() - position.w) 
 		xVel = speedX;
 	else 
 		xVel = 0;
@@ -481,7 +487,7 @@ void Player::GoLeft()
 	
 	current = GetDirection() == Direction::Right? walkRight.get(): walkLeft.get();
 
-	if (position.x >= GAME.MoveBounds.x) 
+	if (position.x >= GAME.WorldMoveBounds().x) 
 		xVel = -speedX;
 	else 
 		xVel = 0;
@@ -0,0 +1,170 @@
+#include "Profiler.h"
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+using namespace std;
+using namespace util;
+
+
+Profiler::Profiler()
+	: frameStart(0)
+	, frameAllocStart(0)
+	, frameCount(0)
+	, epoch(SDL_GetPerformanceCounter())
+	, usPerCount(1000000.0 / (double)SDL_GetPerformanceFrequency())
+{
+	SDL_memset(&current, 0, sizeof(current));
+}
+
+
+const char* Profiler::PhaseName(Phase phase)
+{
+	switch(phase)
+	{
+	case PH_Events:		return "Events";
+	case PH_Update:		return "Update";
+	case PH_Think:		return "Think";
+	case PH_Sort:			return "Sort";
+	case PH_Cull:			return "Cull";
+	case PH_Draw:			return "Draw";
+	case PH_Present:	return "Present";
+	case PH_Frame:		return "Frame";
+	default:					return "?";
+	}
+}
+
+
+Uint64 Profiler::ToMicroseconds(Uint64 counter) const
+{
+	return (Uint64)((counter - epoch) * usPerCount);
+}
+
+
+void Profiler::BeginFrame()
+{
+	SDL_memset(&current, 0, sizeof(current));
+	current.frame = frameCount;
+	frameStart = SDL_GetPerformanceCounter();
+	frameAllocStart = Allocations::Count();
+}
+
+
+void Profiler::EndFrame()
+{
+	Record(PH_Frame, frameStart, SDL_GetPerformanceCounter(), (Uint32)(Allocations::Count() - frameAllocStart));
+	frames.Push(current);
+	++frameCount;
+}
+
+
+void Profiler::Record(Phase phase, Uint64 startCounter, Uint64 endCounter, Uint32 allocs)
+{
+	//Phases can run more than once per frame (e.g. simulation catch-up steps)
+	//keep the first start and the total time
+	if(current.durationUs[phase] == 0)
+		current.startUs[phase] = ToMicroseconds(startCounter);
+	current.durationUs[phase] += (Uint32)((endCounter - startCounter) * usPerCount);
+	current.allocs[phase] += allocs;
+}
+
+
+Profiler::PhaseStats Profiler::Stats(Phase phase, size_t frameCount_) const
+{
+	PhaseStats stats = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const size_t n = SDL_min(frameCount_, frames.Size());
+	if(n == 0) return stats;
+
+	//Fixed scratch - called every few frames from the overlay, no allocations
+	static Uint32 durations[FrameHistory];
+	Uint64 allocs = 0;
+	for(size_t i = 0; i < n; ++i)
+	{
+		durations[i] = frames.Latest(i).durationUs[phase];
+		allocs += frames.Latest(i).allocs[phase];
+	}
+	stats.allocs = (float)allocs / n;
+
+	const size_t i50 = n / 2;
+	const size_t i99 = SDL_min(n - 1, (n * 99) / 100);
+	nth_element(durations, durations + i50, durations + n);
+	stats.p50 = durations[i50] / 1000.0f;
+	nth_element(durations, durations + i99, durations + n);
+	stats.p99 = durations[i99] / 1000.0f;
+	stats.max = *max_element(durations, durations + n) / 1000.0f;
+	return stats;
+}
+
+
+bool Profiler::Export(const string& fileName) const
+{
+	const string ext(".json");
+	if(fileName.size() >= ext.size() && fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0)
+		return ExportTrace(fileName);
+	return ExportCSV(fileName);
+}
+
+
+bool Profiler::ExportCSV(const string& fileName) const
+{
+	unique_ptr2<FILE> file(fopen(fileName.c_str(), "w"), [](FILE* f) { if(f) fclose(f); });
+	if(!file)
+	{
+		logError("Profiler: unable to write %s", fileName.c_str());
+		return false;
+	}
+
+	fprintf(file.get(), "frame,start_us");
+	for(int p = 0; p < PH_Count; ++p)
+		fprintf(file.get(), ",%s_us", PhaseName((Phase)p));
+	for(int p = 0; p < PH_Count; ++p)
+		fprintf(file.get(), ",%s_allocs", PhaseName((Phase)p));
+	fprintf(file.get(), "\n");
+
+	//oldest first
+	for(size_t i = frames.Size(); i-- > 0;)
+	{
+		const FrameSample& frame = frames.Latest(i);
+		fprintf(file.get(), "%llu,%llu", (unsigned long long)frame.frame, (unsigned long long)frame.startUs[PH_Frame]);
+		for(int p = 0; p < PH_Count; ++p)
+			fprintf(file.get(), ",%u", frame.durationUs[p]);
+		for(int p = 0; p < PH_Count; ++p)
+			fprintf(file.get(), ",%u", frame.allocs[p]);
+		fprintf(file.get(), "\n");
+	}
+
+	logPrintf("Profiler: %lu frames written to %s", (unsigned long)frames.Size(), fileName.c_str());
+	return true;
+}
+
+
+bool Profiler::ExportTrace(const string& fileName) const
+{
+	unique_ptr2<FILE> file(fopen(fileName.c_str(), "w"), [](FILE* f) { if(f) fclose(f); });
+	if(!file)
+	{
+		logError("Profiler: unable to write %s", fileName.c_str());
+		return false;
+	}
+
+	//Chrome trace event format - one complete ("X") event per phase per frame
+	fprintf(file.get(), "{\"traceEvents\":[\n");
+	bool first = true;
+	for(size_t i = frames.Size(); i-- > 0;)
+	{
+		const FrameSample& frame = frames.Latest(i);
+		for(int p = 0; p < PH_Count; ++p)
+		{
+			if(frame.durationUs[p] == 0) continue;
+			fprintf(file.get(), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%llu,\"dur\":%u,\"args\":{\"frame\":%llu,\"allocs\":%u}}"
+				, first? "": ",\n", PhaseName((Phase)p), (unsigned long long)frame.startUs[p], frame.durationUs[p]
+				, (unsigned long long)frame.frame, frame.allocs[p]);
+			first = false;
+		}
+	}
+	fprintf(file.get(), "\n]}\n");
+
+	logPrintf("Profiler: %lu frames written to %s", (unsigned long)frames.Size(), fileName.c_str());
+	return true;
+}
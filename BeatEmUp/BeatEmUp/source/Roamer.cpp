@@ -45,15 +45,15 @@ void Roamer::Update()
 }
 
 
-void Roamer::Draw(SDL_Renderer& renderer) const
+void Roamer::Draw(SpriteBatch& batch) const
 {
-	current->Draw(renderer);
+	current->Draw(batch, Interpolate(current->Position()));
 }
 
 
 Roamer::~Roamer()
 {
-	logPrintf("Roamer object released");
+	logTrace("Roamer object released");
 }
 
 
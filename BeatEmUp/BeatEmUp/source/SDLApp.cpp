@@ -1,18 +1,19 @@
 #include "SDLApp.h"
 #include <sstream>
 #include <string>
+#include <cmath>
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
 #include "Util.h"
+#include "Profiler.h"
 
 
-#define FPS_NORMAL			60
-#define FPS_SLOWMOTION	5
+const double SIM_STEP_MS = 1000.0 / SIM_HZ;
 
-//Useful for testing/debugging
-//const int SCREEN_FPS = FPS_SLOWMOTION;
-const int SCREEN_FPS = FPS_NORMAL;
-const int SCREEN_TICKS_PER_FRAME = 1000 / SCREEN_FPS;
+//Max simulation steps per rendered frame
+//Any backlog beyond this is dropped, so a long hitch slows the game down
+//rather than making it spiral trying to catch up
+const int MAX_CATCHUP_STEPS = 5;
 
 
 using namespace util;
@@ -24,7 +25,13 @@ SDLApp::SDLApp(const int clientWidth, const int clientHeight, const std::string&
 	, appTitle_(appTitle)
 	, renderer_(nullptr) 
 	, window_(nullptr)
+	, offscreen_(nullptr)
+	, workers_(std::make_unique<Workers>())
 	, fps_(0.0f)
+	, tps_(0.0f)
+	, alpha_(1.0f)
+	, headless_(false)
+	, tickLimit_(0)
 	, quit_(false)
 	, fullScreen_(false)
 {
@@ -46,6 +53,12 @@ SDLApp::~SDLApp()
 		window_ = nullptr;
 	}
 
+	if(offscreen_)
+	{
+		SDL_FreeSurface( offscreen_ );
+		offscreen_ = nullptr;
+	}
+
 	//Quit SDL subsystems
 	Mix_Quit();
 	TTF_Quit();
@@ -56,31 +69,46 @@ SDLApp::~SDLApp()
 
 bool SDLApp::Init()
 {
-	if( SDL_Init( SDL_INIT_VIDEO | SDL_INIT_AUDIO ) < 0 )
+	if( SDL_Init( headless_? SDL_INIT_TIMER: SDL_INIT_VIDEO | SDL_INIT_AUDIO ) < 0 )
 	{
-		logPrintf( "SDL could not initialize! SDL Error: %s", SDL_GetError() );
+		logError( "SDL could not initialize! SDL Error: %s", SDL_GetError() );
 		return false;
 	}
 
-	window_ = SDL_CreateWindow( appTitle_.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 
-		clientWidth_, clientHeight_, SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOWPOS_CENTERED );
-	if( !window_ )
+	if(headless_)
 	{
-		logPrintf( "Window could not be created! SDL Error: %s", SDL_GetError() );
-		return false;
+		//Software renderer drawing into an offscreen surface
+		//Textures can still be created (and sized) but nothing is ever presented
+		offscreen_ = SDL_CreateRGBSurface( 0, clientWidth_, clientHeight_, 32, 0, 0, 0, 0 );
+		renderer_ = offscreen_? SDL_CreateSoftwareRenderer( offscreen_ ): nullptr;
+		if( !renderer_ )
+		{
+			logError( "Headless renderer could not be created! SDL Error: %s", SDL_GetError() );
+			return false;
+		}
 	}
-
-	//Set texture filtering to linear
-	if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+	else
 	{
-		logPrintf( "Warning: Linear texture filtering not enabled!" );
-	}
+		window_ = SDL_CreateWindow( appTitle_.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 
+			clientWidth_, clientHeight_, SDL_WINDOW_ALLOW_HIGHDPI | SDL_WINDOWPOS_CENTERED );
+		if( !window_ )
+		{
+			logError( "Window could not be created! SDL Error: %s", SDL_GetError() );
+			return false;
+		}
 
-	renderer_ = SDL_CreateRenderer( window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
-	if( !renderer_ )
-	{
-		logPrintf( "Renderer could not be created! SDL Error: %s", SDL_GetError() );
-		return false;
+		//Set texture filtering to linear
+		if( !SDL_SetHint( SDL_HINT_RENDER_SCALE_QUALITY, "1" ) )
+		{
+			logWarn( "Linear texture filtering not enabled!" );
+		}
+
+		renderer_ = SDL_CreateRenderer( window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC );
+		if( !renderer_ )
+		{
+			logError( "Renderer could not be created! SDL Error: %s", SDL_GetError() );
+			return false;
+		}
 	}
 
 	//Initialize renderer color
@@ -91,21 +119,25 @@ bool SDLApp::Init()
 	int imgFlags = IMG_INIT_PNG;
 	if( !( IMG_Init( imgFlags ) & imgFlags ) )
 	{
-		logPrintf( "SDL_image could not initialize! SDL_image Error: %s", IMG_GetError() );
+		logError( "SDL_image could not initialize! SDL_image Error: %s", IMG_GetError() );
 		return false;
 	}
 
 	//Initialize SDL_ttf
 	if( TTF_Init() == -1 )
 	{
-		logPrintf( "SDL_ttf could not initialize! SDL_ttf Error: %s", TTF_GetError() );
+		logError( "SDL_ttf could not initialize! SDL_ttf Error: %s", TTF_GetError() );
 		return false;
 	}
 
 	//Initialize SDL_mixer
-	if( Mix_OpenAudio( 44100, MIX_DEFAULT_FORMAT, 2, 2048 ) < 0 )
+	if( headless_ )
 	{
-		logPrintf( "SDL_mixer could not initialize! SDL_mixer Error: %s", Mix_GetError() );
+		logPrintf( "Headless mode: audio disabled" );
+	}
+	else if( Mix_OpenAudio( 44100, MIX_DEFAULT_FORMAT, 2, 2048 ) < 0 )
+	{
+		logError( "SDL_mixer could not initialize! SDL_mixer Error: %s", Mix_GetError() );
 		//return false;
 	}
 
@@ -115,8 +147,17 @@ bool SDLApp::Init()
 }
 
 
+void SDLApp::SetHeadless(bool enabled, unsigned int tickLimit)
+{
+	headless_ = enabled;
+	tickLimit_ = tickLimit;
+}
+
+
 void SDLApp::ToggleFullScreen()
 {
+	if(!window_) return;
+
 	fullScreen_ = !fullScreen_;
 	SDL_SetWindowFullscreen(window_, fullScreen_? SDL_WINDOW_FULLSCREEN /*SDL_WINDOW_FULLSCREEN_DESKTOP*/ : 0);
 }
@@ -124,28 +165,40 @@ void SDLApp::ToggleFullScreen()
 
 int SDLApp::Run()
 {
+	if(headless_)
+		return RunHeadless();
+
 	SDL_Event e;
 	LTimer fpsTimer;
-	LTimer capTimer;
 	//std::stringstream timeText;
 	int countedFrames = 0;
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 previous = SDL_GetPerformanceCounter();
+	double accumulator = 0.0; //simulation time owed (ms)
 
 	fpsTimer.start();
 
 	while(!quit_)
 	{
-		capTimer.start();
+		PROFILER.BeginFrame();
+
+		const Uint64 now = SDL_GetPerformanceCounter();
+		accumulator += (now - previous) * 1000.0 / frequency * TimeScale();
+		previous = now;
 
 		//Handle events on queue
-		while( SDL_PollEvent( &e ) != 0 )
 		{
-			//User requests quit
-			if( e.type == SDL_QUIT )
+			PROFILE_SCOPE(Profiler::PH_Events);
+			while( SDL_PollEvent( &e ) != 0 )
 			{
-				quit_ = true;
+				//User requests quit
+				if( e.type == SDL_QUIT )
+				{
+					quit_ = true;
+				}
+				
+				ProcessEvent(e);
 			}
-			
-			ProcessEvent(e);
 		}
 
 		//Calculate and correct fps
@@ -163,19 +216,63 @@ int SDLApp::Run()
 		//	//logPrintf("%s", timeText.str().c_str());
 		//}
 
-		Update();
+		//Fixed-step simulation, decoupled from the render rate
+		int steps = 0;
+		while( accumulator >= SIM_STEP_MS && steps < MAX_CATCHUP_STEPS )
+		{
+			Update();
+			accumulator -= SIM_STEP_MS;
+			++steps;
+		}
+
+		//Too far behind - drop the backlog (keep the fraction for a smooth alpha)
+		if( accumulator >= SIM_STEP_MS )
+		{
+			accumulator = std::fmod( accumulator, SIM_STEP_MS );
+		}
+
+		//Render in between the last two simulation states
+		alpha_ = (float)(accumulator / SIM_STEP_MS);
 		Render();
 
 		++countedFrames;
-		//If frame finished early
-		int frameTicks = capTimer.getTicks();
-		if( frameTicks < SCREEN_TICKS_PER_FRAME )
+		PROFILER.EndFrame();
+	}
+
+	return 0;
+}
+
+
+//Simulation only: no event polling, no draw/present and no frame cap
+int SDLApp::RunHeadless()
+{
+	const Uint64 frequency = SDL_GetPerformanceFrequency();
+	const Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 sampleStart = start;
+	unsigned int ticks = 0;
+	unsigned int sampleTicks = 0;
+
+	while(!quit_ && (tickLimit_ == 0 || ticks < tickLimit_))
+	{
+		PROFILER.BeginFrame();
+		Update();
+		PROFILER.EndFrame();
+		++ticks, ++sampleTicks;
+
+		//Refresh the ticks per second (about once a second)
+		const Uint64 now = SDL_GetPerformanceCounter();
+		if(now - sampleStart >= frequency)
 		{
-			//Wait remaining time
-			SDL_Delay( SCREEN_TICKS_PER_FRAME - frameTicks );
+			tps_ = (float)(sampleTicks / ((now - sampleStart) / (double)frequency));
+			sampleStart = now;
+			sampleTicks = 0;
 		}
 	}
 
+	//Report (always - logPrintf is compiled out of release builds)
+	const double seconds = (SDL_GetPerformanceCounter() - start) / (double)frequency;
+	tps_ = seconds > 0.0? (float)(ticks / seconds): 0.0f;
+	printf("Headless run: %u ticks in %.3f s (%.1f ticks/sec, %.1fx real time)\n"
+		, ticks, seconds, tps_, tps_ / SIM_HZ);
 	return 0;
 }
-
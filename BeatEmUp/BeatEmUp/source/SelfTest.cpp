@@ -0,0 +1,148 @@
+#include "SelfTest.h"
+#include "Util.h"
+#include "InputRecording.h"
+#include "CppEvent.h"
+#include "Handle.h"
+#include "Workers.h"
+#include <stdio.h>
+#include <vector>
+
+
+using namespace std;
+using namespace util;
+
+
+static bool Report(const char* name, bool passed)
+{
+	printf("Self-test: %-24s %s\n", name, passed? "ok": "FAILED");
+	return passed;
+}
+
+
+//First outputs of the reference implementation (pcg32-demo, seed 42, stream 54)
+static bool CheckRandom()
+{
+	static const Uint32 Expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+	Random rng(42, 54);
+	for(const Uint32 value : Expected)
+		if(rng.NextU32() != value) return false;
+
+	//Same seed and stream, same numbers; forks likewise
+	Random a(7, 3), b(7, 3);
+	Random forkA = a.Fork(), forkB = b.Fork();
+	for(int i = 0; i < 100; ++i)
+		if(a.Next(0, 1000) != b.Next(0, 1000) || forkA.NextU32() != forkB.NextU32()) return false;
+	return true;
+}
+
+
+//Save then Load: same header, every action due on its own tick and not before
+//(tick deltas picked to need 1 to 6 varint bytes)
+static bool CheckRecording()
+{
+	static const Uint64 Ticks[] = { 0, 0, 1, 127, 128, 300, 16384, 20000, 1ull << 40 };
+	const char* const FileName = "selftest.beur";
+
+	InputRecording recording;
+	recording.Start(0x123456789abcdefull);
+	for(size_t i = 0; i < SDL_arraysize(Ticks); ++i)
+		recording.Record(Ticks[i], (InputRecording::Action)(i % InputRecording::A_Count));
+	recording.Finish((1ull << 40) + 1, 0xdeadbeef);
+	if(!recording.Save(FileName)) return false;
+
+	InputRecording loaded;
+	const bool read = loaded.Load(FileName);
+	remove(FileName);
+	if(!read || !loaded.IsPlaying() || loaded.Seed() != recording.Seed() || loaded.EndTick() != recording.EndTick()
+		|| loaded.Checksum() != recording.Checksum() || loaded.Count() != recording.Count())
+		return false;
+
+	InputRecording::Action action;
+	for(size_t i = 0; i < SDL_arraysize(Ticks); ++i)
+	{
+		if(Ticks[i] > 0 && Ticks[i] != Ticks[i - 1] && loaded.Next(Ticks[i] - 1, action)) return false;
+		if(!loaded.Next(Ticks[i], action) || action != (InputRecording::Action)(i % InputRecording::A_Count)) return false;
+	}
+	return !loaded.Next(~0ull, action) && !loaded.Ended(recording.EndTick() - 1) && loaded.Ended(recording.EndTick());
+}
+
+
+//Detached handlers stop being called, and their (stale) tokens cannot
+//detach whatever reuses the slot
+struct Counter
+{
+	int calls;
+	void OnEvent(int, int value) { calls += value; }
+};
+
+static bool CheckEvents()
+{
+	events::Event<int, int> event;
+	Counter first = { 0 }, second = { 0 };
+	events::Token firstToken = event.attach(first, &Counter::OnEvent);
+	events::Token secondToken = event.attach(second, &Counter::OnEvent);
+	event.notify(0, 1);
+	if(first.calls != 1 || second.calls != 1) return false;
+
+	const events::Token stale = firstToken;
+	if(!event.detach(firstToken) || firstToken.generation != 0 || event.count() != 1) return false;
+	event.notify(0, 1);
+	if(first.calls != 1 || second.calls != 2) return false;
+
+	events::Token staleCopy = stale;
+	events::Token thirdToken = event.attach(first, &Counter::OnEvent); //takes the freed slot
+	if(thirdToken.slot != stale.slot || event.detach(staleCopy) || event.count() != 2) return false;
+	event.notify(0, 1);
+	return first.calls == 2 && second.calls == 3
+		&& event.detach(secondToken) && event.detach(thirdToken) && event.count() == 0;
+}
+
+
+//A removed object's handle resolves to nothing, even once its slot is reused
+static bool CheckHandles()
+{
+	int a = 0, b = 0;
+	HandleTable<int> table;
+	const Handle ha = table.Add(&a);
+	if(table.Get(ha) != &a) return false;
+	table.Remove(ha);
+	table.Remove(ha); //stale: no-op
+	if(table.Get(ha) || table.Count() != 0) return false;
+
+	const Handle hb = table.Add(&b);
+	if(hb.index != ha.index || hb.generation == ha.generation || table.Get(ha) || table.Get(hb) != &b) return false;
+	table.Clear();
+	return !table.Get(hb) && table.Count() == 0;
+}
+
+
+//Every index visited exactly once, whatever the count/grain split
+static bool CheckParallelFor()
+{
+	static const size_t Counts[] = { 0, 1, 63, 64, 65, 1000, 10007 };
+	Workers workers;
+	for(const size_t count : Counts)
+	{
+		vector<Uint8> hits(count, 0); //each index written by one chunk only
+		workers.ParallelFor(count, 64, [&hits](size_t begin, size_t end)
+		{
+			for(size_t i = begin; i < end; ++i)
+				++hits[i];
+		});
+		for(const Uint8 hit : hits)
+			if(hit != 1) return false;
+	}
+	return true;
+}
+
+
+int SelfTest::Run()
+{
+	int failed = 0;
+	failed += !Report("PCG32 reference", CheckRandom());
+	failed += !Report("Recording round trip", CheckRecording());
+	failed += !Report("Event tokens", CheckEvents());
+	failed += !Report("Handle generations", CheckHandles());
+	failed += !Report("ParallelFor coverage", CheckParallelFor());
+	return failed;
+}
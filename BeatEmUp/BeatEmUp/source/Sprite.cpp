@@ -3,10 +3,15 @@
 
 
 
-Sprite::Sprite(SDL_Surface* const spriteSheet, SDL_Renderer& renderer, 
+Sprite::Sprite(const TextureRef& spriteSheet, 
 	int frameWidth, int frameHeight, int frameSpeed_, int stillFrame_, bool playReverse)
 	: GameObject("", GT_Sprite)
-	, sheet(nullptr)
+	, sheet(spriteSheet.texture)
+	, region(spriteSheet.rect)
+	, framesPerRow(1)
+	, rowCount(1)
+	, frameCount(1)
+	, counter(0)
 	, frameSpeed(frameSpeed_)
 	, stillFrame(stillFrame_)
 	, fromIndex(0)
@@ -20,17 +25,13 @@ Sprite::Sprite(SDL_Surface* const spriteSheet, SDL_Renderer& renderer,
 
 	position.x = 100, position.y = 400;
 	position.w = (float)frameWidth, position.h = (float)frameHeight;
-	framesPerRow = (int)SDL_floor((double)spriteSheet->w / frameWidth);
-	rowCount = (int)SDL_floor((double)spriteSheet->h / frameHeight);
+	framesPerRow = (int)SDL_floor((double)region.w / frameWidth);
+	rowCount = (int)SDL_floor((double)region.h / frameHeight);
 	frameCount = framesPerRow * rowCount;
-	sheet = unique_ptr2<SDL_Texture>(
-		SDL_CreateTextureFromSurface(&renderer, spriteSheet), 
-		[](auto p) { SDL_DestroyTexture(p); }
-	);
 
 	fromIndex = 0;
 	toIndex = frameCount - 1;
-	logPrintf("spritesheet loaded (%d,%d) %d frames", spriteSheet->w, spriteSheet->h, frameCount);
+	logTrace("spritesheet loaded (%d,%d) %d frames", region.w, region.h, frameCount);
 }
 
 
@@ -74,16 +75,21 @@ void Sprite::Update()
 }
 
 
-void Sprite::Draw(SDL_Renderer& renderer) const
+void Sprite::Draw(SpriteBatch& batch) const
+{
+	Draw(batch, position);
+}
+
+
+void Sprite::Draw(SpriteBatch& batch, const RectF& dest) const
 {
 	int row = currentFrame / framesPerRow;
 	int col = currentFrame % framesPerRow;
-	SDL_Rect src = { (int)((float)col * position.w), (int)((float)row * position.h)
+	//frame within the sheet (region of a possibly shared atlas page)
+	SDL_Rect src = { region.x + (int)((float)col * position.w), region.y + (int)((float)row * position.h)
 		, (int)position.w, (int)position.h };
 
-	SDL_Rect nPos;
-	util::Convert(position, nPos);
-	SDL_RenderCopyEx(&renderer, sheet.get(), &src, &nPos, GetAngle(), nullptr, SDL_FLIP_NONE);
+	batch.Draw(sheet.get(), src, dest, GetAngle());
 
 	if(!loop && IsAnimationRunning())
 	{
@@ -95,5 +101,5 @@ void Sprite::Draw(SDL_Renderer& renderer) const
 
 Sprite::~Sprite()
 {
-	logPrintf("Sprite object released");
+	logTrace("Sprite object released");
 }
@@ -0,0 +1,152 @@
+#include "SpriteBatch.h"
+#include <cmath>
+
+
+using namespace util;
+
+
+static const SDL_Colour White = { 0xFF, 0xFF, 0xFF, 0xFF };
+static const double Pi = 3.14159265358979323846;
+
+
+SpriteBatch::SpriteBatch(SDL_Renderer& renderer_, size_t initialCapacity)
+	: renderer(renderer_)
+	, texture(nullptr)
+	, translateX(0.0f)
+	, translateY(0.0f)
+	, dryRun(false)
+	, drawCalls(0)
+	, quads(0)
+{
+	pending.reserve(initialCapacity);
+#if SPRITEBATCH_GEOMETRY
+	vertices.reserve(initialCapacity * 4);
+	indices.reserve(initialCapacity * 6);
+#endif
+}
+
+
+void SpriteBatch::Draw(SDL_Texture* texture_, const SDL_Rect& src, const RectF& dest, double angle)
+{
+	Draw(texture_, src, dest, angle, White);
+}
+
+
+void SpriteBatch::Draw(SDL_Texture* texture_, const SDL_Rect& src, const RectF& dest, double angle, const SDL_Colour& colour)
+{
+	if(!texture_) return;
+
+	//Texture switch ends the current run
+	if(texture_ != texture)
+	{
+		Submit();
+		texture = texture_;
+	}
+
+	//Whole pixels: floor rather than truncate, so both sides of 0 snap the same way
+	Quad quad = { src, dest, angle, colour };
+	quad.dest.x = std::floor(dest.x + translateX);
+	quad.dest.y = std::floor(dest.y + translateY);
+	quad.dest.w = (float)(int)dest.w;
+	quad.dest.h = (float)(int)dest.h;
+	pending.push_back(quad);
+	++quads;
+}
+
+
+void SpriteBatch::Flush()
+{
+	Submit();
+	texture = nullptr;
+}
+
+
+#if SPRITEBATCH_GEOMETRY
+
+void SpriteBatch::Submit()
+{
+	if(pending.empty()) return;
+
+	int texW = 0, texH = 0;
+	SDL_QueryTexture(texture, nullptr, nullptr, &texW, &texH);
+	const float invW = 1.0f / (float)texW;
+	const float invH = 1.0f / (float)texH;
+
+	vertices.clear();
+	indices.clear();
+	for(const Quad& quad : pending)
+	{
+		const int base = (int)vertices.size();
+		const float u0 = quad.src.x * invW, u1 = (quad.src.x + quad.src.w) * invW;
+		const float v0 = quad.src.y * invH, v1 = (quad.src.y + quad.src.h) * invH;
+
+		//Corners relative to the centre (SDL_RenderCopyEx rotates around the centre of dest)
+		const float hw = quad.dest.w / 2.0f, hh = quad.dest.h / 2.0f;
+		const float cx = quad.dest.x + hw, cy = quad.dest.y + hh;
+		const float corners[4][2] = { { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } };
+		const float uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+
+		float c = 1.0f, s = 0.0f;
+		if(quad.angle != 0.0)
+		{
+			const double radians = quad.angle * Pi / 180.0;
+			c = (float)cos(radians), s = (float)sin(radians);
+		}
+
+		for(int i = 0; i < 4; ++i)
+		{
+			SDL_Vertex v;
+			v.position.x = cx + corners[i][0] * c - corners[i][1] * s;
+			v.position.y = cy + corners[i][0] * s + corners[i][1] * c;
+			v.color = quad.colour;
+			v.tex_coord.x = uvs[i][0];
+			v.tex_coord.y = uvs[i][1];
+			vertices.push_back(v);
+		}
+
+		const int quadIndices[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+		indices.insert(indices.end(), quadIndices, quadIndices + 6);
+	}
+
+	if(!dryRun)
+		SDL_RenderGeometry(&renderer, texture, vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+	++drawCalls;
+	pending.clear();
+}
+
+#else
+
+void SpriteBatch::Submit()
+{
+	if(pending.empty()) return;
+	if(dryRun)
+	{
+		drawCalls += pending.size();
+		pending.clear();
+		return;
+	}
+
+	//Textures are left with a white colour mod - only change it for runs that need another
+	SDL_Colour mod = White;
+	for(const Quad& quad : pending)
+	{
+		if(quad.colour.r != mod.r || quad.colour.g != mod.g || quad.colour.b != mod.b)
+		{
+			mod = quad.colour;
+			SDL_SetTextureColorMod(texture, mod.r, mod.g, mod.b);
+		}
+
+		SDL_Rect dest;
+		Convert(quad.dest, dest);
+		if(quad.angle == 0.0)
+			SDL_RenderCopy(&renderer, texture, &quad.src, &dest);
+		else
+			SDL_RenderCopyEx(&renderer, texture, &quad.src, &dest, quad.angle, nullptr, SDL_FLIP_NONE);
+		++drawCalls;
+	}
+	if(mod.r != White.r || mod.g != White.g || mod.b != White.b)
+		SDL_SetTextureColorMod(texture, White.r, White.g, White.b);
+	pending.clear();
+}
+
+#endif
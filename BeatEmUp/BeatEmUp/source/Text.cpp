@@ -1,4 +1,5 @@
 #include "Text.h"
+#include "Assets.h"
 
 
 
@@ -6,40 +7,95 @@
 TextBlock::TextBlock(const string& text_, size_t size, float x, float y, SDL_Renderer& renderer_)
 	: GameObject("", GT_Background)
 	, text(text_)
-	, font(make_unique<TTFont>("resources/calibri.ttf", size))
+	, font(ASSETS.Font("resources/calibri.ttf", (int)size, renderer_))
+#if !SPRITEBATCH_GEOMETRY
+	, ttf(make_unique<TTFont>("resources/calibri.ttf", size))
+	, renderer(renderer_)
+#endif
 {
 	position.x = x, position.y = y;
-	int w = 0, h = 0;
-	TTF_SizeText(font->font, text.c_str(), &w, &h);
-	position.w = (float)w, position.h = (float)h;	
-	SetColour(0, 0, 0, 0);
+	position.w = (float)font->Measure(text), position.h = (float)font->LineHeight();
+	//Alpha is used now (TTF_RenderText_Solid ignored it), so keep it opaque
+	SetColour(0, 0, 0, 0xFF);
+#if !SPRITEBATCH_GEOMETRY
+	SDL_zero(lineColour);
+#endif
 }
 
 
 
 TextBlock::~TextBlock()
 {
-	logPrintf("TextBlock released");
+	logTrace("TextBlock released");
+}
+
+
+
+void TextBlock::SetText(const string& txt)
+{
+	if(txt == text) return;
+	text = txt;
+	position.w = (float)font->Measure(text);
+}
+
+
+void TextBlock::SetText(const char* txt)
+{
+	if(text == txt) return;
+	text.assign(txt);
+	position.w = (float)font->Measure(text);
 }
 
 
 
 void TextBlock::Update()
 {
-	int w = 0, h = 0;
-	TTF_SizeText(font->font, text.c_str(), &w, &h);
-	position.w = (float)w, position.h = (float)h;	
 }
 
 
 
-void TextBlock::Draw(SDL_Renderer& renderer) const
+#if SPRITEBATCH_GEOMETRY
+
+void TextBlock::Draw(SpriteBatch& batch) const
 {
-	if(!font) return;
+	font->Draw(batch, text, position.x, position.y, colour);
+}
+
+#else
 
-	TextTexture texture(renderer, *font, text, colour);
+void TextBlock::Draw(SpriteBatch& batch) const
+{
+	if(text != lineText || colour.r != lineColour.r || colour.g != lineColour.g
+		|| colour.b != lineColour.b || colour.a != lineColour.a)
+		Rasterise();
+	if(!line) return;
 
-	SDL_Rect nPos;
-	util::Convert(position, nPos);
-	SDL_RenderCopyEx(&renderer, texture.texture, nullptr, &nPos, GetAngle(), nullptr, SDL_FLIP_NONE);
+	SDL_Rect src = { 0, 0, 0, 0 };
+	SDL_QueryTexture(line.get(), nullptr, nullptr, &src.w, &src.h);
+	batch.Draw(line.get(), src, RectF(position.x, position.y, (float)src.w, (float)src.h));
 }
+
+
+void TextBlock::Rasterise() const
+{
+	lineText = text, lineColour = colour;
+	line.reset();
+	if(text.empty() || !ttf->font) return;
+
+	unique_ptr2<SDL_Surface> surface(TTF_RenderText_Blended(ttf->font, text.c_str(), colour)
+		, [](SDL_Surface* s) { if(s) SDL_FreeSurface(s); });
+	if(!surface)
+	{
+		logError("TextBlock ERROR: %s", TTF_GetError());
+		return;
+	}
+	line = shared_ptr<SDL_Texture>(SDL_CreateTextureFromSurface(&renderer, surface.get())
+		, [](SDL_Texture* p) { if(p) SDL_DestroyTexture(p); });
+	if(!line.get())
+	{
+		logError("TextBlock ERROR: %s", SDL_GetError());
+		line.reset();
+	}
+}
+
+#endif
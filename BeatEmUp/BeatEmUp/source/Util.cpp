@@ -14,7 +14,7 @@ namespace util
 	{
 		if(!surface)
 		{
-			logPrintf( "Unable to load image %s! SDL_image Error: %s", path.c_str(), IMG_GetError() );
+			logError( "Unable to load image %s! SDL_image Error: %s", path.c_str(), IMG_GetError() );
 		}
 		else
 		{
@@ -39,6 +39,22 @@ namespace util
 	}
 
 
+	SDL_Surface* CreateRGBASurface(int width, int height)
+	{
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		const Uint32 rmask = 0xff000000, gmask = 0x00ff0000, bmask = 0x0000ff00, amask = 0x000000ff;
+#else
+		const Uint32 rmask = 0x000000ff, gmask = 0x0000ff00, bmask = 0x00ff0000, amask = 0xff000000;
+#endif
+		SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, rmask, gmask, bmask, amask);
+		if(!surface)
+		{
+			logError( "Unable to create %dx%d surface! SDL Error: %s", width, height, SDL_GetError() );
+		}
+		return surface;
+	}
+
+
 	LTimer::LTimer()
 	{
 		//Initialize the variables
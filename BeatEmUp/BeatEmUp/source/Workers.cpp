@@ -0,0 +1,301 @@
+#include "Workers.h"
+#include "Util.h"
+#include "Allocations.h"
+
+
+using namespace std;
+
+
+//Which Workers/deque the current thread belongs to (unset = main thread, deque 0)
+static thread_local const Workers* currentOwner = nullptr;
+static thread_local unsigned int currentIndex = 0;
+
+
+static __forceinline Uint64 ElapsedUs(Uint64 start)
+{
+	return (SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency();
+}
+
+
+Workers::Queue::Queue()
+	: head(0)
+	, tasksRun(0)
+	, steals(0)
+	, failedSteals(0)
+	, idleUs(0)
+{
+}
+
+
+Workers::Workers(unsigned int threadCount)
+	: queued(0)
+	, stop(false)
+{
+	if(threadCount == 0)
+	{
+		const unsigned int cores = thread::hardware_concurrency();
+		threadCount = cores > 1? cores - 1: 0;
+	}
+
+	for(unsigned int i = 0; i <= threadCount; ++i)
+		queues.push_back(make_unique<Queue>());
+
+	threads.reserve(threadCount);
+	for(unsigned int i = 1; i <= threadCount; ++i)
+		threads.emplace_back(&Workers::WorkerMain, this, i);
+	logPrintf("Workers: %u threads", threadCount);
+}
+
+
+Workers::~Workers()
+{
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stop = true;
+	}
+	wake.notify_all();
+	for(auto& t : threads) t.join();
+	LogStats();
+}
+
+
+void Workers::Run(TaskGroup& group, Task task, TaskGroup* after)
+{
+	ALLOC_TAG("Workers::Run");
+	++group.pending;
+	TaskGroup::Deferred deferred = { std::move(task), &group };
+
+	if(after)
+	{
+		lock_guard<mutex> lock(after->mutex);
+		if(after->pending != 0)
+		{
+			after->continuations.push_back(std::move(deferred));
+			return;
+		}
+	}
+
+	Push(Self(), &deferred, 1);
+}
+
+
+void Workers::Wait(TaskGroup& group)
+{
+	const unsigned int self = Self();
+	while(!group.Done())
+	{
+		if(RunOne(self)) continue;
+
+		//What is left is running on other threads - sleep until it is done,
+		//or until something is queued that this thread can help with
+		const Uint64 start = SDL_GetPerformanceCounter();
+		{
+			unique_lock<mutex> lock(sleepMutex);
+			finished.wait(lock, [&] { return group.Done() || queued > 0; });
+		}
+		queues[self]->idleUs += ElapsedUs(start);
+	}
+
+	//The last task to finish may still be holding the group's lock (see Finish)
+	lock_guard<mutex> lock(group.mutex);
+}
+
+
+void Workers::ParallelFor(size_t count, size_t grain, const function<void(size_t, size_t)>& fn)
+{
+	if(count == 0) return;
+	if(grain == 0) grain = 1;
+
+	//Not worth waking anybody
+	if(threads.empty() || count <= grain)
+	{
+		fn(0, count);
+		return;
+	}
+
+	//All chunks go in under one lock, with one wake-up for everybody
+	//Last chunk first: this thread pops from the back, so it starts on the
+	//first chunk while the others steal from the far end
+	ALLOC_TAG("Workers::ParallelFor");
+	TaskGroup group;
+	const unsigned int self = Self();
+	const size_t chunks = (count + grain - 1) / grain;
+	group.pending = chunks;
+	{
+		Queue& q = *queues[self];
+		lock_guard<mutex> lock(q.mutex);
+		for(size_t chunk = chunks; chunk-- > 0;)
+		{
+			const size_t begin = chunk * grain;
+			const size_t end = SDL_min(begin + grain, count);
+			q.tasks.push_back(TaskGroup::Deferred{ [&fn, begin, end] { fn(begin, end); }, &group });
+		}
+	}
+	Signal(chunks);
+	Wait(group);
+}
+
+
+Workers::Stats Workers::GetStats(unsigned int thread) const
+{
+	const Queue& q = *queues[thread];
+	return Stats{ q.tasksRun, q.steals, q.failedSteals, q.idleUs };
+}
+
+
+Workers::Stats Workers::TotalStats() const
+{
+	Stats total = {};
+	for(unsigned int i = 0; i < queues.size(); ++i)
+	{
+		const Stats s = GetStats(i);
+		total.tasks += s.tasks;
+		total.steals += s.steals;
+		total.failedSteals += s.failedSteals;
+		total.idleUs += s.idleUs;
+	}
+	return total;
+}
+
+
+void Workers::ResetStats()
+{
+	for(auto& q : queues)
+		q->tasksRun = 0, q->steals = 0, q->failedSteals = 0, q->idleUs = 0;
+}
+
+
+void Workers::LogStats() const
+{
+	for(unsigned int i = 0; i < queues.size(); ++i)
+	{
+		const Stats s = GetStats(i);
+		logPrintf("Workers[%u]: %llu tasks, %llu stolen, %llu failed steals, %.1f ms idle", i
+			, (unsigned long long)s.tasks, (unsigned long long)s.steals
+			, (unsigned long long)s.failedSteals, s.idleUs / 1000.0);
+	}
+}
+
+
+void Workers::WorkerMain(unsigned int self)
+{
+	currentOwner = this;
+	currentIndex = self;
+
+	for(;;)
+	{
+		if(RunOne(self)) continue;
+
+		//Nothing anywhere - sleep until something is queued
+		const Uint64 start = SDL_GetPerformanceCounter();
+		bool quit;
+		{
+			unique_lock<mutex> lock(sleepMutex);
+			wake.wait(lock, [this] { return stop || queued > 0; });
+			quit = stop;
+		}
+		queues[self]->idleUs += ElapsedUs(start);
+		if(quit) return;
+	}
+}
+
+
+void Workers::Push(unsigned int self, TaskGroup::Deferred* deferred, size_t count)
+{
+	if(count == 0) return;
+	{
+		lock_guard<mutex> lock(queues[self]->mutex);
+		for(size_t i = 0; i < count; ++i)
+			queues[self]->tasks.push_back(std::move(deferred[i]));
+	}
+	Signal(count);
+}
+
+
+void Workers::Signal(size_t count)
+{
+	queued += count;
+
+	//Taking the lock orders this with a thread about to sleep, so it cannot miss the wake
+	{
+		lock_guard<mutex> lock(sleepMutex);
+	}
+	if(count == 1) wake.notify_one();
+	else wake.notify_all();
+	finished.notify_one(); //the main thread may be waiting in Wait
+}
+
+
+bool Workers::Pop(unsigned int self, TaskGroup::Deferred& out)
+{
+	Queue& q = *queues[self];
+	lock_guard<mutex> lock(q.mutex);
+	if(q.head == q.tasks.size()) return false;
+	out = std::move(q.tasks.back());
+	q.tasks.pop_back();
+	if(q.head == q.tasks.size()) q.tasks.clear(), q.head = 0;
+	--queued;
+	return true;
+}
+
+
+bool Workers::Steal(unsigned int self, TaskGroup::Deferred& out)
+{
+	const size_t n = queues.size();
+	for(size_t i = 1; i < n; ++i)
+	{
+		Queue& victim = *queues[(self + i) % n];
+		lock_guard<mutex> lock(victim.mutex);
+		if(victim.head == victim.tasks.size()) continue;
+		out = std::move(victim.tasks[victim.head++]);
+		if(victim.head == victim.tasks.size()) victim.tasks.clear(), victim.head = 0;
+		--queued;
+		++queues[self]->steals;
+		return true;
+	}
+	++queues[self]->failedSteals;
+	return false;
+}
+
+
+bool Workers::RunOne(unsigned int self)
+{
+	TaskGroup::Deferred deferred;
+	if(!Pop(self, deferred) && !Steal(self, deferred)) return false;
+
+	deferred.task();
+	++queues[self]->tasksRun;
+	Finish(self, *deferred.group);
+	return true;
+}
+
+
+//The group's count drops under its lock, so Run(after) either sees it done or
+//leaves a continuation that is released here
+void Workers::Finish(unsigned int self, TaskGroup& group)
+{
+	vector<TaskGroup::Deferred> ready;
+	{
+		lock_guard<mutex> lock(group.mutex);
+		if(--group.pending != 0) return;
+		ready.swap(group.continuations);
+	}
+
+	if(!ready.empty())
+	{
+		Push(self, ready.data(), ready.size());
+		return;
+	}
+
+	//Wake Wait() - group may be gone once it returns, so only our own members from here
+	{
+		lock_guard<mutex> lock(sleepMutex);
+	}
+	finished.notify_one();
+}
+
+
+unsigned int Workers::Self() const
+{
+	return currentOwner == this? currentIndex: 0;
+}
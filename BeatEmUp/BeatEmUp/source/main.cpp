@@ -1,14 +1,150 @@
 #include "Game.h"
+#include "Profiler.h"
+#include "Allocations.h"
+#include "SelfTest.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <vector>
 
 
 int main( int argc, char* args[] )
 {
 
 	{
+		//--headless [ticks]
+		//Runs the game logic only (no window/renderer/audio) and reports ticks per second
+		//--profile <file>
+		//Writes the profiler frame history on exit (.json = Chrome trace, otherwise CSV)
+		//--bench [counts] [ticks]
+		//Headless throughput benchmark over stress levels, e.g. --bench 10,100,1000,10000 600
+		//--selftest
+		//Runs the self-checks (RNG, recordings, events, handles, workers, determinism); fails (exit code) if any does
+		//--seed <n>
+		//Seeds the random numbers (default: the clock, or 1 for benchmarks) - same seed, same run
+		//--alloc-tags
+		//Counts heap allocations per ALLOC_TAG and lists them on exit
+		//--zero-alloc [warmup ticks]
+		//Fails (exit code) if any tick/frame after the warmup (default 300) allocates
+		//--record <file>
+		//Records the player's actions (and the seed) to file on exit
+		//--replay <file>
+		//Plays a recording back instead of the keyboard (with --headless: flat out)
+		//and fails (exit code) if it does not end in the recorded state
+		const char* profileFile = nullptr;
+		const char* recordFile = nullptr;
+		const char* replayFile = nullptr;
+		bool allocTags = false;
+		bool zeroAlloc = false;
+		bool seeded = false;
+		bool selfTest = false;
+		std::vector<size_t> benchCounts;
+		unsigned int benchTicks = 600;
+		for(int i = 1; i < argc; ++i)
+		{
+			if(strcmp(args[i], "--headless") == 0)
+			{
+				unsigned int ticks = 0;
+				if(i + 1 < argc && isdigit(args[i + 1][0]))
+				{
+					char* end = nullptr;
+					ticks = (unsigned int)strtoul(args[++i], &end, 10);
+					if(*end)
+					{
+						fprintf(stderr, "--headless: bad tick count '%s'\n", args[i]);
+						return EXIT_FAILURE;
+					}
+				}
+				Game::Instance().SetHeadless(true, ticks);
+			}
+			else if(strcmp(args[i], "--bench") == 0)
+			{
+				const char* counts = (i + 1 < argc && args[i + 1][0] != '-')? args[++i]: "10,100,1000,10000";
+				for(char* end = nullptr; *counts; counts = (*end == ',')? end + 1: end)
+				{
+					const size_t count = (size_t)strtoul(counts, &end, 10);
+					if(end == counts || count == 0 || (*end && *end != ',') || (*end == ',' && !end[1]))
+					{
+						fprintf(stderr, "--bench: bad enemy counts '%s' (usage: --bench [n,n,...] [ticks], n > 0)\n", args[i]);
+						return EXIT_FAILURE;
+					}
+					benchCounts.push_back(count);
+				}
+				if(i + 1 < argc && args[i + 1][0] != '-')
+				{
+					char* end = nullptr;
+					benchTicks = (unsigned int)strtoul(args[++i], &end, 10);
+					if(*end || benchTicks == 0)
+					{
+						fprintf(stderr, "--bench: bad tick count '%s'\n", args[i]);
+						return EXIT_FAILURE;
+					}
+				}
+				Game::Instance().SetHeadless(true);
+			}
+			else if(strcmp(args[i], "--selftest") == 0)
+			{
+				selfTest = true;
+				Game::Instance().SetHeadless(true);
+			}
+			else if(strcmp(args[i], "--profile") == 0 && i + 1 < argc)
+			{
+				profileFile = args[++i];
+			}
+			else if(strcmp(args[i], "--alloc-tags") == 0)
+			{
+				allocTags = true;
+				Allocations::EnableTags(true);
+			}
+			else if(strcmp(args[i], "--zero-alloc") == 0)
+			{
+				const bool warmup = i + 1 < argc && isdigit(args[i + 1][0]);
+				Game::Instance().SetZeroAllocCheck(warmup? strtoull(args[++i], nullptr, 10): 300);
+				zeroAlloc = true;
+			}
+			else if(strcmp(args[i], "--seed") == 0 && i + 1 < argc)
+			{
+				__WHEEL.Seed(strtoull(args[++i], nullptr, 10));
+				seeded = true;
+			}
+			else if(strcmp(args[i], "--record") == 0 && i + 1 < argc)
+			{
+				recordFile = args[++i];
+				Game::Instance().SetRecordInput(true);
+			}
+			else if(strcmp(args[i], "--replay") == 0 && i + 1 < argc)
+			{
+				replayFile = args[++i];
+			}
+		}
+		//The recording's seed wins over --seed
+		if(replayFile && !Game::Instance().SetReplay(replayFile)) return EXIT_FAILURE;
+		if((!benchCounts.empty() || selfTest) && !seeded) __WHEEL.Seed(1);
+
+		if(selfTest)
+		{
+			int failed = SelfTest::Run();
+			if(!Game::Instance().Init() || !Game::Instance().CheckDeterminism(100, 600)) ++failed;
+			printf("Self-test: %d check(s) failed\n", failed);
+			return failed? EXIT_FAILURE: EXIT_SUCCESS;
+		}
+
 		if(Game::Instance().Init())
 		{
-			Game::Instance().Run();
+			if(!benchCounts.empty()) Game::Instance().RunBenchmark(benchCounts, benchTicks);
+			else Game::Instance().Run();
+			if(profileFile) PROFILER.Export(profileFile);
+			if(recordFile) Game::Instance().SaveRecording(recordFile);
+			if(replayFile && !Game::Instance().CheckReplay()) return EXIT_FAILURE;
+		}
+		if(allocTags) Allocations::LogTags();
+
+		if(zeroAlloc)
+		{
+			const Uint64 failures = Game::Instance().ZeroAllocFailures();
+			printf("Zero-alloc check: %llu tick(s)/frame(s) allocated\n", (unsigned long long)failures);
+			if(failures) return EXIT_FAILURE;
 		}
 	}
 	
@@ -48,7 +184,7 @@ Demo::Demo()
 
 Demo::~Demo()
 {
-	logPrintf("Demo object destroyed");
+	logTrace("Demo object destroyed");
 }
 
 